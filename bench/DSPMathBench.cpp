@@ -0,0 +1,642 @@
+/*                                                                     *\
+**       __   ___  ______                                              **
+**      / /  / _ \/_  __/                                              **
+**     / /__/ , _/ / /    Lindenberg                                   **
+**    /____/_/|_| /_/  Research Tec.                                   **
+**                                                                     **
+**                                                                     **
+**	  https://github.com/lindenbergresearch/LRTRack	                   **
+**    heapdump@icloud.com                                              **
+**		                                                               **
+**    Sound Modules for VCV Rack                                       **
+**    Copyright 2017-2019 by Patrick Lindenberg / LRT                  **
+**                                                                     **
+**    For Redistribution and use in source and binary forms,           **
+**    with or without modification please see LICENSE.                 **
+**                                                                     **
+\*                                                                     */
+
+/**
+ * @brief Standalone accuracy / speed benchmark of the approximations in DSPMath and LambertW
+ *
+ * Every approximation is swept over its domain and compared to a double precision reference (libm,
+ * or a polished Lambert-W), reported as max. and RMS error. Throughput is measured on a block of
+ * inputs for the scalar version, the libm function it replaces and the lane-wise versions from
+ * DSPSimd.hpp where they exist. A second sweep over denormal inputs gives the error there and the
+ * slowdown against normal inputs.
+ *
+ * The shapers with a lane-wise version (pow2bpol, cubicShape, atanShaper, clip) are exact formulas,
+ * their reference is the same formula in double precision, so the error is rounding only.
+ *
+ * With --check the timing is skipped. Scalar, float4 and float8 versions are checked against the
+ * documented bounds, and the lane-wise versions against the scalar one (bit-identical where it is
+ * documented). Every violation is listed and the exit code is 1.
+ *
+ * Usage: DSPMathBench [--json | --check]
+ */
+#include <cfloat>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "DSPMath.hpp"
+#include "DSPSimd.hpp"
+#include "LambertW.h"
+
+using namespace lrt;
+
+static const int ERROR_POINTS = 1 << 20;
+static const int DENORMAL_POINTS = 1 << 14;
+static const int TIMING_POINTS = 4096;
+static const int TIMING_EVALUATIONS = 1 << 23;
+
+static const char *ERROR_NAMES[] = {"abs", "rel", "phase"};
+
+/* wrapTWOPI() rounds n / 2PI to float, the phase error grows with |n|, this is for |n| <= 1000 */
+static const double WRAP_BOUND = 1e-4;
+
+/* the lane-wise wrapTWOPI() may swap PI and -PI on ties, their distance is the float TWOPI */
+static const double WRAP_TIE = fabs(TWOPI - 2. * M_PI);
+
+/* the shapers are exact formulas, a few float roundings */
+static const double SHAPER_BOUND = 4. * FLT_EPSILON;
+
+
+/**
+ * @brief A block of inputs run through one implementation
+ */
+struct Kernel {
+    virtual ~Kernel() {}
+
+
+    virtual void load(const std::vector<double> &x) = 0;
+    virtual void run() = 0;
+    virtual double get(int i) const = 0;
+};
+
+
+template<typename V, typename F>
+struct ScalarKernel : Kernel {
+    F f;
+    std::vector<V> in, out;
+
+
+    explicit ScalarKernel(F f) : f(f) {}
+
+
+    void load(const std::vector<double> &x) override {
+        in.assign(x.begin(), x.end());
+        out.assign(x.size(), V(0));
+    }
+
+
+    void run() override {
+        for (size_t i = 0; i < in.size(); i++) {
+            out[i] = f(in[i]);
+        }
+    }
+
+
+    double get(int i) const override {
+        return out[i];
+    }
+};
+
+
+template<typename T, typename F>
+struct VectorKernel : Kernel {
+    F f;
+    std::vector<float> in, out;
+
+
+    explicit VectorKernel(F f) : f(f) {}
+
+
+    /* padded to full vectors */
+    void load(const std::vector<double> &x) override {
+        in.assign(x.begin(), x.end());
+        in.resize((x.size() + T::SIZE - 1) / T::SIZE * T::SIZE, in.back());
+        out.assign(in.size(), 0.f);
+    }
+
+
+    void run() override {
+        for (size_t i = 0; i < in.size(); i += T::SIZE) {
+            f(T::load(&in[i])).store(&out[i]);
+        }
+    }
+
+
+    double get(int i) const override {
+        return out[i];
+    }
+};
+
+
+template<typename V, typename F>
+Kernel *scalar(F f) {
+    return new ScalarKernel<V, F>(f);
+}
+
+
+template<typename T, typename F>
+Kernel *lanes(F f) {
+    return new VectorKernel<T, F>(f);
+}
+
+
+/**
+ * @brief lambert_W_Halley() as it is used on a signal, starting from the previous result
+ */
+struct HalleyWarmStart {
+    double last = 0.;
+
+
+    double operator()(double x) {
+        return last = lambert_W_Halley(x, last);
+    }
+};
+
+
+/**
+ * @brief Reference Lambert-W: Veberic's solution, polished by Halley steps in long double
+ */
+static double referenceW(double x) {
+    long double w = LambertW<0>(x);
+
+    for (int i = 0; i < 3 && w != 0; i++) {
+        long double e = expl(w);
+        long double p = w * e - x;
+
+        w -= p / (e * (w + 1) - (w + 2) * p / (2 * w + 2));
+    }
+
+    return (double) w;
+}
+
+
+/**
+ * @brief One approximation under test
+ */
+struct Entry {
+    enum Sweep {
+        LINEAR,
+        LOG
+    };
+
+    enum Error {
+        ABSOLUTE,
+        RELATIVE,
+        PHASE // absolute, modulo 2 * PI
+    };
+
+    std::string name;
+    bool precision; // double precision
+    double lo, hi;
+    Sweep sweep;
+    Error error;
+    std::function<double(double)> reference;
+
+    Kernel *approx;
+    Kernel *libm = nullptr;
+    Kernel *simd4 = nullptr;
+    Kernel *simd8 = nullptr;
+
+    /* documented bounds checked by --check, NAN where nothing is documented */
+    double bound = NAN;         // scalar against the reference
+    double simdBound = NAN;     // lane-wise against the reference
+    double simdDeviation = NAN; // lane-wise against scalar, 0 means bit-identical
+
+
+    Entry(const std::string &name, bool precision, double lo, double hi, Sweep sweep, Error error,
+          std::function<double(double)> reference, Kernel *approx) :
+            name(name), precision(precision), lo(lo), hi(hi), sweep(sweep), error(error), reference(reference), approx(approx) {}
+
+
+    ~Entry() {
+        delete approx;
+        delete libm;
+        delete simd4;
+        delete simd8;
+    }
+
+
+    Entry *withLibm(Kernel *k) {
+        libm = k;
+        return this;
+    }
+
+
+    Entry *withSIMD(Kernel *k4, Kernel *k8) {
+        simd4 = k4;
+        simd8 = k8;
+        return this;
+    }
+
+
+    Entry *withBounds(double bound, double simdBound, double simdDeviation) {
+        Entry::bound = bound;
+        Entry::simdBound = simdBound;
+        Entry::simdDeviation = simdDeviation;
+        return this;
+    }
+
+
+    double measureError(double y, double x) const {
+        return measureDeviation(y, reference(x));
+    }
+
+
+    double measureDeviation(double y, double r) const {
+        switch (error) {
+            case RELATIVE:
+                return fabs(y - r) / fmax(fabs(r), DBL_MIN);
+            case PHASE:
+                return fabs(remainder(y - r, 2. * M_PI));
+            default:
+                return fabs(y - r);
+        }
+    }
+};
+
+
+/**
+ * @brief Ascending inputs over lo..hi, stored as the precision of the entry
+ */
+static std::vector<double> points(const Entry *e, double lo, double hi, Entry::Sweep sweep, int n) {
+    std::vector<double> x(n);
+
+    for (int i = 0; i < n; i++) {
+        double t = i / (n - 1.);
+        x[i] = sweep == Entry::LOG ? lo * pow(hi / lo, t) : lo + (hi - lo) * t;
+        if (!e->precision) x[i] = (float) x[i];
+    }
+
+    return x;
+}
+
+
+struct ErrorStats {
+    double max = 0.;
+    double rms = 0.;
+    double at = 0.;
+};
+
+
+static ErrorStats measureError(const Entry *e, Kernel *k, const std::vector<double> &x) {
+    ErrorStats s;
+
+    k->load(x);
+    k->run();
+
+    for (size_t i = 0; i < x.size(); i++) {
+        double err = e->measureError(k->get(i), x[i]);
+
+        /* NaN and infinity count as infinite error */
+        if (!(err <= DBL_MAX)) err = INFINITY;
+
+        if (err > s.max) {
+            s.max = err;
+            s.at = x[i];
+        }
+
+        s.rms += err * err;
+    }
+
+    s.rms = sqrt(s.rms / x.size());
+
+    return s;
+}
+
+
+/**
+ * @brief Max. deviation of a lane-wise version from the scalar one, in the error measure of the entry
+ */
+static ErrorStats measureDeviation(const Entry *e, Kernel *k, const std::vector<double> &x) {
+    ErrorStats s;
+
+    e->approx->load(x);
+    e->approx->run();
+    k->load(x);
+    k->run();
+
+    for (size_t i = 0; i < x.size(); i++) {
+        double a = e->approx->get(i), b = k->get(i);
+
+        /* exact comparison first, the error measures are not zero for equal infinities */
+        double dev = a == b ? 0. : e->measureDeviation(b, a);
+        if (!(dev <= DBL_MAX)) dev = INFINITY;
+
+        if (dev > s.max) {
+            s.max = dev;
+            s.at = x[i];
+        }
+    }
+
+    return s;
+}
+
+
+/**
+ * @brief Prints one checked value and counts the violations
+ */
+static void check(const Entry *e, const char *what, const ErrorStats &s, double bound, int &failed) {
+    if (std::isnan(bound)) return;
+
+    bool ok = s.max <= bound;
+    if (!ok) failed++;
+
+    printf("%-22s %-16s %10.2e %10.2e %14.7g  %s\n", e->name.c_str(), what, s.max, bound, s.at, ok ? "ok" : "FAIL");
+}
+
+
+/**
+ * @brief Float copy of the inputs, the lane-wise versions are single precision
+ */
+static std::vector<double> floatPoints(const std::vector<double> &x) {
+    std::vector<double> xf(x.begin(), x.end());
+    for (double &v : xf) v = (float) v;
+
+    return xf;
+}
+
+
+/**
+ * @brief Checks all entries against their documented bounds
+ * @return Number of violations
+ */
+static int checkBounds(const std::vector<Entry *> &entries) {
+    int failed = 0;
+
+    printf("%-22s %-16s %10s %10s %14s\n", "function", "check", "max", "bound", "at");
+
+    for (Entry *e : entries) {
+        std::vector<double> x = points(e, e->lo, e->hi, e->sweep, ERROR_POINTS);
+        std::vector<double> xf = floatPoints(x);
+
+        check(e, "scalar", measureError(e, e->approx, x), e->bound, failed);
+
+        if (e->simd4) {
+            check(e, "float4", measureError(e, e->simd4, xf), e->simdBound, failed);
+            check(e, "float8", measureError(e, e->simd8, xf), e->simdBound, failed);
+            check(e, "float4 - scalar", measureDeviation(e, e->simd4, xf), e->simdDeviation, failed);
+            check(e, "float8 - scalar", measureDeviation(e, e->simd8, xf), e->simdDeviation, failed);
+        }
+    }
+
+    printf("%d violation(s)\n", failed);
+
+    return failed;
+}
+
+
+/**
+ * @brief Average time per evaluation in nanoseconds
+ */
+static double measureTime(Kernel *k, const std::vector<double> &x) {
+    if (k == nullptr) return NAN;
+
+    k->load(x);
+    k->run();
+
+    int repeat = TIMING_EVALUATIONS / (int) x.size();
+    auto start = std::chrono::steady_clock::now();
+
+    for (int n = 0; n < repeat; n++) {
+        k->run();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+
+    return ns / repeat / x.size();
+}
+
+
+static void printNumber(bool json, const char *format, double v) {
+    if (std::isnan(v)) printf(json ? "null" : "%10s", "-");
+    else printf(format, v);
+}
+
+
+int main(int argc, char **argv) {
+    bool json = false, checkOnly = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) json = true;
+        if (strcmp(argv[i], "--check") == 0) checkOnly = true;
+    }
+
+    const float fastPowExp = 1.5f, fastPowRootExp = 0.5f;
+    const double precisePowExp = 3.7;
+
+    /* saturation of the clip() entry */
+    const float clipSat = 2.f, clipSatInv = 1.f / clipSat;
+
+    std::vector<Entry *> entries = {
+            (new Entry("fastSin", false, -M_PI, M_PI, Entry::LINEAR, Entry::ABSOLUTE, [](double x) { return sin(x); },
+                       scalar<float>([](float x) { return fastSin(x); })))
+                    ->withLibm(scalar<float>([](float x) { return sinf(x); }))
+                    ->withSIMD(lanes<float4>([](float4 x) { return simd::fastSin(x); }),
+                               lanes<float8>([](float8 x) { return simd::fastSin(x); }))
+                    ->withBounds(1.9e-4, 1.9e-4, 0.),
+
+            (new Entry("wrapTWOPI", false, -1000., 1000., Entry::LINEAR, Entry::PHASE, [](double x) { return x; },
+                       scalar<float>([](float x) { return wrapTWOPI(x); })))
+                    ->withLibm(scalar<float>([](float x) { return remainderf(x, TWOPI); }))
+                    ->withSIMD(lanes<float4>([](float4 x) { return simd::wrapTWOPI(x); }),
+                               lanes<float8>([](float8 x) { return simd::wrapTWOPI(x); }))
+                    ->withBounds(WRAP_BOUND, WRAP_BOUND, WRAP_TIE),
+
+            (new Entry("fastatan", false, -1., 1., Entry::LINEAR, Entry::ABSOLUTE, [](double x) { return atan(x); },
+                       scalar<float>([](float x) { return fastatan(x); })))
+                    ->withLibm(scalar<float>([](float x) { return atanf(x); }))
+                    ->withSIMD(lanes<float4>([](float4 x) { return simd::fastatan(x); }),
+                               lanes<float8>([](float8 x) { return simd::fastatan(x); }))
+                    ->withBounds(4.9e-3, 4.9e-3, 0.),
+
+            (new Entry("fastTan", false, 0., 0.49 * M_PI, Entry::LINEAR, Entry::RELATIVE, [](double x) { return tan(x); },
+                       scalar<float>([](float x) { return fastTan(x); })))
+                    ->withLibm(scalar<float>([](float x) { return tanf(x); }))
+                    ->withSIMD(lanes<float4>([](float4 x) { return fastTan(x); }),
+                               lanes<float8>([](float8 x) { return fastTan(x); }))
+                    ->withBounds(4e-6, 4e-6, 0.),
+
+            (new Entry("fastlog2", false, 1e-30, 1e30, Entry::LOG, Entry::ABSOLUTE, [](double x) { return log2(x); },
+                       scalar<float>([](float x) { return fastlog2(x); })))
+                    ->withLibm(scalar<float>([](float x) { return log2f(x); }))
+                    ->withSIMD(lanes<float4>([](float4 x) { return simd::fastlog2(x); }),
+                               lanes<float8>([](float8 x) { return simd::fastlog2(x); }))
+                    ->withBounds(9e-3, 9e-3, 0.),
+
+            (new Entry("fastlog", false, 1e-30, 1e30, Entry::LOG, Entry::ABSOLUTE, [](double x) { return log(x); },
+                       scalar<float>([](float x) { return fastlog(x); })))
+                    ->withLibm(scalar<float>([](float x) { return logf(x); }))
+                    ->withSIMD(lanes<float4>([](float4 x) { return simd::fastlog(x); }),
+                               lanes<float8>([](float8 x) { return simd::fastlog(x); }))
+                    ->withBounds(9e-3 * M_LN2, 9e-3 * M_LN2, 0.),
+
+            (new Entry("fastPow(x, 1.5)", false, 0.01, 100., Entry::LOG, Entry::RELATIVE,
+                       [=](double x) { return pow(x, (double) fastPowExp); },
+                       scalar<float>([=](float x) { return fastPow(x, fastPowExp); })))
+                    ->withLibm(scalar<float>([=](float x) { return powf(x, fastPowExp); }))
+                    ->withSIMD(lanes<float4>([=](float4 x) { return simd::fastPow(x, float4(fastPowExp)); }),
+                               lanes<float8>([=](float8 x) { return simd::fastPow(x, float8(fastPowExp)); }))
+                    ->withBounds(0.18, 0.18, 0.),
+
+            (new Entry("fastPow(x, 0.5)", false, 0.01, 100., Entry::LOG, Entry::RELATIVE,
+                       [=](double x) { return pow(x, (double) fastPowRootExp); },
+                       scalar<float>([=](float x) { return fastPow(x, fastPowRootExp); })))
+                    ->withLibm(scalar<float>([=](float x) { return powf(x, fastPowRootExp); }))
+                    ->withSIMD(lanes<float4>([=](float4 x) { return simd::fastPow(x, float4(fastPowRootExp)); }),
+                               lanes<float8>([=](float8 x) { return simd::fastPow(x, float8(fastPowRootExp)); }))
+                    ->withBounds(0.06, 0.06, 0.),
+
+            (new Entry("fastPrecisePow(x, 3.7)", true, 0.01, 100., Entry::LOG, Entry::RELATIVE,
+                       [=](double x) { return pow(x, precisePowExp); },
+                       scalar<double>([=](double x) { return fastPrecisePow(x, precisePowExp); })))
+                    ->withLibm(scalar<double>([=](double x) { return pow(x, precisePowExp); })),
+
+            (new Entry("fastExp2", false, -100., 100., Entry::LINEAR, Entry::RELATIVE, [](double x) { return exp2(x); },
+                       scalar<float>([](float x) { return fastExp2(x); })))
+                    ->withLibm(scalar<float>([](float x) { return exp2f(x); }))
+                    ->withSIMD(lanes<float4>([](float4 x) { return simd::fastExp2(x); }),
+                               lanes<float8>([](float8 x) { return simd::fastExp2(x); }))
+                    ->withBounds(3e-7, 3e-7, 0.),
+
+            (new Entry("erf", true, -4., 4., Entry::LINEAR, Entry::ABSOLUTE, [](double x) { return std::erf(x); },
+                       scalar<double>([](double x) { return lrt::erf(x); })))
+                    ->withLibm(scalar<double>([](double x) { return std::erf(x); }))
+                    ->withSIMD(lanes<float4>([](float4 x) { return simd::erf(x); }),
+                               lanes<float8>([](float8 x) { return simd::erf(x); }))
+                    ->withBounds(1.5e-7, 8e-7, 1.5e-7 + 8e-7),
+
+            (new Entry("pow2bpol", false, -10., 10., Entry::LINEAR, Entry::RELATIVE, [](double x) { return x * fabs(x); },
+                       scalar<float>([](float x) { return pow2bpol(x); })))
+                    ->withSIMD(lanes<float4>([](float4 x) { return simd::pow2bpol(x); }),
+                               lanes<float8>([](float8 x) { return simd::pow2bpol(x); }))
+                    ->withBounds(SHAPER_BOUND, SHAPER_BOUND, 0.),
+
+            (new Entry("cubicShape", false, 0., 1., Entry::LINEAR, Entry::ABSOLUTE,
+                       [](double x) { return (x - 1.) * (x - 1.) * (x - 1.) + 1.; },
+                       scalar<float>([](float x) { return cubicShape(x); })))
+                    ->withSIMD(lanes<float4>([](float4 x) { return simd::cubicShape(x); }),
+                               lanes<float8>([](float8 x) { return simd::cubicShape(x); }))
+                    ->withBounds(SHAPER_BOUND, SHAPER_BOUND, 0.),
+
+            (new Entry("atanShaper", false, -10., 10., Entry::LINEAR, Entry::RELATIVE,
+                       [](double x) { return x / (1. + (double) 0.28f * x * x); },
+                       scalar<float>([](float x) { return atanShaper(x); })))
+                    ->withSIMD(lanes<float4>([](float4 x) { return simd::atanShaper(x); }),
+                               lanes<float8>([](float8 x) { return simd::atanShaper(x); }))
+                    ->withBounds(SHAPER_BOUND, SHAPER_BOUND, 0.),
+
+            (new Entry("clip(x, 2)", false, -4., 4., Entry::LINEAR, Entry::ABSOLUTE,
+                       [=](double x) {
+                           double v = fmin(fmax(x / clipSat, -1.), 1.);
+                           return clipSat * (v - v * v * v / 3.);
+                       },
+                       scalar<float>([=](float x) { return clip(x, clipSat, clipSatInv); })))
+                    ->withSIMD(lanes<float4>([=](float4 x) { return simd::clip(x, clipSat, clipSatInv); }),
+                               lanes<float8>([=](float8 x) { return simd::clip(x, clipSat, clipSatInv); }))
+                    ->withBounds(SHAPER_BOUND * clipSat, SHAPER_BOUND * clipSat, 0.),
+
+            new Entry("lambert_W_Halley", true, 0., 100., Entry::LINEAR, Entry::RELATIVE, referenceW,
+                      scalar<double>(HalleyWarmStart())),
+
+            new Entry("lambert_W_Fritsch", true, 0., 100., Entry::LINEAR, Entry::RELATIVE, referenceW,
+                      scalar<double>([](double x) { return lambert_W_Fritsch(x); })),
+
+            new Entry("fakedLambertW", true, 0., 100., Entry::LINEAR, Entry::RELATIVE, referenceW,
+                      scalar<double>([](double x) { return fakedLambertW(x); })),
+
+            new Entry("LambertW<0>", true, 0., 100., Entry::LINEAR, Entry::RELATIVE, referenceW,
+                      scalar<double>([](double x) { return LambertW<0>(x); })),
+    };
+
+    if (checkOnly) {
+        int failed = checkBounds(entries);
+        for (Entry *e : entries) delete e;
+
+        return failed > 0 ? 1 : 0;
+    }
+
+    if (json) {
+        printf("{\n  \"results\": [\n");
+    } else {
+        printf("%-22s %-5s %10s %10s %10s %10s %10s %10s %10s %10s %10s %10s\n", "function", "error", "max", "rms",
+               "simd4 max", "simd8 max", "ns approx", "ns libm", "ns simd4", "ns simd8", "denorm max", "denorm x");
+    }
+
+    for (size_t ei = 0; ei < entries.size(); ei++) {
+        Entry *e = entries[ei];
+
+        std::vector<double> x = points(e, e->lo, e->hi, e->sweep, ERROR_POINTS);
+        std::vector<double> t = points(e, e->lo, e->hi, e->sweep, TIMING_POINTS);
+
+        /* positive subnormals of the precision used */
+        double dlo = e->precision ? std::numeric_limits<double>::denorm_min() : std::numeric_limits<float>::denorm_min();
+        double dhi = e->precision ? DBL_MIN : FLT_MIN;
+        std::vector<double> d = points(e, dlo, dhi, Entry::LOG, DENORMAL_POINTS);
+
+        ErrorStats err = measureError(e, e->approx, x);
+        ErrorStats denormal = measureError(e, e->approx, d);
+
+        /* the lane-wise versions are single precision and run on float inputs */
+        double simd4Max = NAN, simd8Max = NAN;
+
+        if (e->simd4) {
+            std::vector<double> xf = floatPoints(x);
+            simd4Max = measureError(e, e->simd4, xf).max;
+            simd8Max = measureError(e, e->simd8, xf).max;
+        }
+
+        double nsApprox = measureTime(e->approx, t);
+        double nsLibm = measureTime(e->libm, t);
+        double nsSIMD4 = measureTime(e->simd4, t);
+        double nsSIMD8 = measureTime(e->simd8, t);
+
+        /* slowdown on subnormal inputs, blocks of the same size */
+        std::vector<double> dt = points(e, dlo, dhi, Entry::LOG, TIMING_POINTS);
+        double slowdown = measureTime(e->approx, dt) / nsApprox;
+
+        if (json) {
+            printf("    {\"name\": \"%s\", \"precision\": \"%s\", \"lo\": %g, \"hi\": %g, \"error\": \"%s\", \"max\": %.3e, "
+                   "\"max_at\": %.9g, \"rms\": %.3e, \"simd4_max\": ",
+                   e->name.c_str(), e->precision ? "double" : "float", e->lo, e->hi, ERROR_NAMES[e->error], err.max, err.at, err.rms);
+            printNumber(true, "%.3e", simd4Max);
+            printf(", \"simd8_max\": ");
+            printNumber(true, "%.3e", simd8Max);
+            printf(", \"ns_approx\": %.3f, \"ns_libm\": ", nsApprox);
+            printNumber(true, "%.3f", nsLibm);
+            printf(", \"ns_simd4\": ");
+            printNumber(true, "%.3f", nsSIMD4);
+            printf(", \"ns_simd8\": ");
+            printNumber(true, "%.3f", nsSIMD8);
+            printf(", \"denormal_max\": %.3e, \"denormal_slowdown\": %.2f}%s\n", denormal.max, slowdown,
+                   ei + 1 < entries.size() ? "," : "");
+        } else {
+            printf("%-22s %-5s %10.2e %10.2e ", e->name.c_str(), ERROR_NAMES[e->error], err.max, err.rms);
+            printNumber(false, "%10.2e", simd4Max);
+            printf(" ");
+            printNumber(false, "%10.2e", simd8Max);
+            printf(" %10.2f ", nsApprox);
+            printNumber(false, "%10.2f", nsLibm);
+            printf(" ");
+            printNumber(false, "%10.2f", nsSIMD4);
+            printf(" ");
+            printNumber(false, "%10.2f", nsSIMD8);
+            printf(" %10.2e %10.2f\n", denormal.max, slowdown);
+        }
+
+        delete e;
+    }
+
+    if (json) printf("  ]\n}\n");
+
+    return 0;
+}
@@ -0,0 +1,309 @@
+/*                                                                     *\
+**       __   ___  ______                                              **
+**      / /  / _ \/_  __/                                              **
+**     / /__/ , _/ / /    Lindenberg                                   **
+**    /____/_/|_| /_/  Research Tec.                                   **
+**                                                                     **
+**                                                                     **
+**	  https://github.com/lindenbergresearch/LRTRack	                   **
+**    heapdump@icloud.com                                              **
+**		                                                               **
+**    Sound Modules for VCV Rack                                       **
+**    Copyright 2017-2019 by Patrick Lindenberg / LRT                  **
+**                                                                     **
+**    For Redistribution and use in source and binary forms,           **
+**    with or without modification please see LICENSE.                 **
+**                                                                     **
+\*                                                                     */
+
+/**
+ * @brief Standalone CPU / aliasing benchmark of the oscillator cores
+ *
+ * Timing runs 16 voices through DSPBLOscillator and through SIMDOscillatorBank with 4 and 8 lanes,
+ * once per waveform core. Aliasing is measured on a single DSPBLOscillator: after the warmup the
+ * pitch is read back, a Blackman-Harris windowed FFT is taken and every bin within the main lobe
+ * of a harmonic counts as signal, everything else as alias.
+ *
+ * Usage: OscillatorBench [--json] [samplerate]
+ */
+#include <chrono>
+#include <complex>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Oscillator.hpp"
+#include "SIMDOscillatorBank.hpp"
+
+using namespace lrt;
+
+static const int VOICES = 16;
+static const int FFT_SIZE = 8192;
+static const int MAIN_LOBE = 4;
+static const int TIMING_SAMPLES = 1 << 16;
+
+/* long enough for the warmup detune to settle */
+static const float WARMUP_SECONDS = 10.f;
+
+static const char *CORE_NAMES[] = {"blit", "polyblep"};
+static const char *WAVE_NAMES[] = {"saw", "pulse", "tri"};
+
+
+/**
+ * @brief 16 voices of one implementation under test
+ */
+struct Candidate {
+    std::string name;
+    DSPBLOscillator::Core core;
+    float cv[VOICES], fm[VOICES], pw[VOICES];
+
+
+    Candidate(const std::string &name, DSPBLOscillator::Core core) : name(name), core(core) {
+        /* spread the voices over the keyboard */
+        for (int i = 0; i < VOICES; i++) {
+            cv[i] = (i - VOICES / 2) * 0.3f;
+            fm[i] = 0.f;
+            pw[i] = 0.7f;
+        }
+    }
+
+
+    virtual ~Candidate() {}
+
+
+    virtual float process() = 0;
+};
+
+
+struct ScalarCandidate : Candidate {
+    DSPBLOscillator *osc[VOICES];
+
+
+    ScalarCandidate(float sr, DSPBLOscillator::Core core) : Candidate("scalar", core) {
+        for (int i = 0; i < VOICES; i++) {
+            osc[i] = new DSPBLOscillator(sr);
+            osc[i]->setCore(core);
+        }
+    }
+
+
+    ~ScalarCandidate() override {
+        for (int i = 0; i < VOICES; i++) {
+            delete osc[i];
+        }
+    }
+
+
+    float process() override {
+        float sum = 0.f;
+
+        for (int i = 0; i < VOICES; i++) {
+            osc[i]->setInputs(cv[i], 0.f, fm[i], 0.f, 0.f);
+            osc[i]->setPulseWidth(pw[i]);
+            osc[i]->process();
+
+            sum += osc[i]->getSawWave() + osc[i]->getPulseWave() + osc[i]->getSineWave() + osc[i]->getTriWave() + osc[i]->getNoise();
+        }
+
+        return sum;
+    }
+};
+
+
+template<typename T>
+struct BankCandidate : Candidate {
+    SIMDOscillatorBank<T, VOICES> *bank;
+    float buffer[SIMDOscillatorBank<T, VOICES>::MIX][VOICES];
+
+
+    BankCandidate(const std::string &name, float sr, DSPBLOscillator::Core core) : Candidate(name, core) {
+        bank = new SIMDOscillatorBank<T, VOICES>(sr);
+        bank->setChannels(VOICES);
+        bank->setCore(core);
+
+        for (int i = 0; i < SIMDOscillatorBank<T, VOICES>::MIX; i++) {
+            bank->out[i] = buffer[i];
+        }
+    }
+
+
+    ~BankCandidate() override {
+        delete bank;
+    }
+
+
+    float process() override {
+        bank->setInputs(cv, fm, pw, 0.f, 0.f);
+        bank->process();
+
+        return buffer[0][VOICES - 1];
+    }
+};
+
+
+/**
+ * @brief In place radix-2 FFT
+ */
+static void fft(std::complex<double> *x, int n) {
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+
+        if (i < j) std::swap(x[i], x[j]);
+    }
+
+    for (int len = 2; len <= n; len <<= 1) {
+        std::complex<double> wl(cos(-2. * M_PI / len), sin(-2. * M_PI / len));
+
+        for (int i = 0; i < n; i += len) {
+            std::complex<double> w(1.);
+
+            for (int j = 0; j < len / 2; j++) {
+                std::complex<double> u = x[i + j];
+                std::complex<double> v = x[i + j + len / 2] * w;
+
+                x[i + j] = u + v;
+                x[i + j + len / 2] = u - v;
+                w *= wl;
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Signal to alias ratio in dB of SAW, PULSE and TRI at the given V/Oct
+ */
+static void measureSNR(float sr, DSPBLOscillator::Core core, float cv, double *snr, float *hz) {
+    DSPBLOscillator osc(sr);
+    osc.setCore(core);
+
+    std::vector<std::complex<double>> x[3];
+    for (int w = 0; w < 3; w++) x[w].resize(FFT_SIZE);
+
+    int warmup = (int) (sr * WARMUP_SECONDS);
+
+    for (int n = 0; n < warmup + FFT_SIZE; n++) {
+        osc.setInputs(cv, 0.f, 0.f, 0.f, 0.f);
+        osc.setPulseWidth(0.7f);
+        osc.process();
+
+        if (n < warmup) continue;
+
+        /* 4 term Blackman-Harris, side lobes below -92dB */
+        double p = 2. * M_PI * (n - warmup) / FFT_SIZE;
+        double win = 0.35875 - 0.48829 * cos(p) + 0.14128 * cos(2. * p) - 0.01168 * cos(3. * p);
+
+        x[0][n - warmup] = osc.getSawWave() * win;
+        x[1][n - warmup] = osc.getPulseWave() * win;
+        x[2][n - warmup] = osc.getTriWave() * win;
+    }
+
+    *hz = osc.getFrequency();
+    double f0 = *hz / sr * FFT_SIZE;
+
+    for (int w = 0; w < 3; w++) {
+        fft(x[w].data(), FFT_SIZE);
+
+        double signal = 0., alias = 0.;
+
+        for (int i = 1; i < FFT_SIZE / 2; i++) {
+            double p = std::norm(x[w][i]);
+
+            /* distance to the nearest harmonic */
+            double h = fmax(1., round(i / f0));
+
+            if (fabs(i - h * f0) <= MAIN_LOBE) signal += p;
+            else alias += p;
+        }
+
+        snr[w] = 10. * log10(signal / fmax(alias, 1e-30));
+    }
+}
+
+
+/**
+ * @brief Average processing time per sample and voice in nanoseconds
+ */
+static double measureTime(Candidate *c) {
+    volatile float sink = 0.f;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int n = 0; n < TIMING_SAMPLES; n++) {
+        sink = sink + c->process();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+
+    return ns / TIMING_SAMPLES / VOICES;
+}
+
+
+int main(int argc, char **argv) {
+    bool json = false;
+    float sr = 44100.f;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) json = true;
+        else sr = (float) atof(argv[i]);
+    }
+
+    std::vector<Candidate *> candidates;
+
+    for (int c = 0; c < 2; c++) {
+        auto core = (DSPBLOscillator::Core) c;
+
+        candidates.push_back(new ScalarCandidate(sr, core));
+        candidates.push_back(new BankCandidate<float4>("bank-simd4", sr, core));
+        candidates.push_back(new BankCandidate<float8>("bank-simd8", sr, core));
+    }
+
+    const float pitches[] = {-2.f, 0.f, 2.f, 3.5f, 4.5f};
+    const int numPitches = sizeof(pitches) / sizeof(pitches[0]);
+
+    if (json) printf("{\n  \"samplerate\": %g,\n  \"voices\": %d,\n  \"timing\": [\n", sr, VOICES);
+    else printf("%-12s %-10s %10s\n", "engine", "core", "ns/voice");
+
+    for (size_t ci = 0; ci < candidates.size(); ci++) {
+        Candidate *c = candidates[ci];
+        double ns = measureTime(c);
+
+        if (json) {
+            printf("    {\"name\": \"%s\", \"core\": \"%s\", \"ns_per_voice\": %.3f}%s\n", c->name.c_str(), CORE_NAMES[c->core], ns,
+                   ci + 1 < candidates.size() ? "," : "");
+        } else {
+            printf("%-12s %-10s %10.2f\n", c->name.c_str(), CORE_NAMES[c->core], ns);
+        }
+
+        delete c;
+    }
+
+    if (json) printf("  ],\n  \"aliasing\": [\n");
+    else printf("\n%-10s %10s %10s %10s %10s\n", "core", "hz", "saw snr", "pulse snr", "tri snr");
+
+    for (int c = 0; c < 2; c++) {
+        for (int i = 0; i < numPitches; i++) {
+            double snr[3];
+            float hz;
+
+            measureSNR(sr, (DSPBLOscillator::Core) c, pitches[i], snr, &hz);
+
+            if (json) {
+                printf("    {\"core\": \"%s\", \"hz\": %.2f", CORE_NAMES[c], hz);
+                for (int w = 0; w < 3; w++) printf(", \"%s_db\": %.2f", WAVE_NAMES[w], snr[w]);
+                printf("}%s\n", c == 1 && i == numPitches - 1 ? "" : ",");
+            } else {
+                printf("%-10s %10.1f %10.2f %10.2f %10.2f\n", CORE_NAMES[c], hz, snr[0], snr[1], snr[2]);
+            }
+        }
+    }
+
+    if (json) printf("  ]\n}\n");
+
+    return 0;
+}
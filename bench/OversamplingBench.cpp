@@ -0,0 +1,372 @@
+/*                                                                     *\
+**       __   ___  ______                                              **
+**      / /  / _ \/_  __/                                              **
+**     / /__/ , _/ / /    Lindenberg                                   **
+**    /____/_/|_| /_/  Research Tec.                                   **
+**                                                                     **
+**                                                                     **
+**	  https://github.com/lindenbergresearch/LRTRack	                   **
+**    heapdump@icloud.com                                              **
+**		                                                               **
+**    Sound Modules for VCV Rack                                       **
+**    Copyright 2017-2019 by Patrick Lindenberg / LRT                  **
+**                                                                     **
+**    For Redistribution and use in source and binary forms,           **
+**    with or without modification please see LICENSE.                 **
+**                                                                     **
+\*                                                                     */
+
+/**
+ * @brief Standalone CPU / aliasing benchmark of all oversampling configurations
+ *
+ * Every configuration runs a set of sine tones through a hard clipper at the oversampled rate.
+ * The tones are placed exactly on FFT bins, so all harmonics and all aliases land on bins too and
+ * no window is needed: every bin on an unfolded harmonic counts as signal, everything else as alias.
+ *
+ * Usage: OversamplingBench [--json] [samplerate]
+ */
+#include <chrono>
+#include <complex>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "DSPEffect.hpp"
+#include "RateConverter.hpp"
+#include "SIMDResampler.hpp"
+
+using namespace lrt;
+
+static const int FFT_SIZE = 8192;
+static const int WARMUP = 1024;
+static const int TIMING_SAMPLES = 1 << 18;
+static const int TONES = 24;
+
+static const float CLIP_DRIVE = 4.f;
+
+
+/**
+ * @brief Hard nonlinearity, produces harmonics up to infinity
+ */
+inline float clip(float x) {
+    x *= CLIP_DRIVE;
+    return x > 1.f ? 1.f : (x < -1.f ? -1.f : x);
+}
+
+
+/**
+ * @brief One oversampler configuration under test
+ */
+struct Candidate {
+    std::string name;
+    int factor;
+    int lanes = 1;
+
+
+    Candidate(const std::string &name, int factor) : name(name), factor(factor) {}
+
+
+    virtual ~Candidate() {}
+
+
+    virtual void reset() = 0;
+    virtual float process(float x) = 0;
+    virtual double getLatency() = 0;
+};
+
+
+/**
+ * @brief Reference without any oversampling
+ */
+struct DirectCandidate : Candidate {
+    DirectCandidate() : Candidate("direct", 1) {}
+
+
+    void reset() override {}
+
+
+    float process(float x) override {
+        return clip(x);
+    }
+
+
+    double getLatency() override {
+        return 0.;
+    }
+};
+
+
+struct ResamplerCandidate : Candidate {
+    Resampler<1> *rs;
+
+
+    ResamplerCandidate(const std::string &name, int oversample, int quality, Resampler<1>::Type type) :
+            Candidate(name, oversample) {
+        rs = new Resampler<1>(oversample, quality, type);
+    }
+
+
+    ~ResamplerCandidate() override {
+        delete rs;
+    }
+
+
+    void reset() override {
+        rs->reset();
+    }
+
+
+    float process(float x) override {
+        rs->doUpsample(0, x);
+
+        float *up = rs->getUpsampled(0);
+        for (int i = 0; i < factor; i++) {
+            rs->data[0][i] = clip(up[i]);
+        }
+
+        return (float) rs->getDownsampled(0);
+    }
+
+
+    double getLatency() override {
+        return rs->getLatency();
+    }
+};
+
+
+struct NeoCandidate : Candidate {
+    NeoOversampler *neo;
+    float buffer[NEO_MAX_RATIO];
+
+
+    NeoCandidate(const std::string &name, int ratio, bool minimumPhase) : Candidate(name, ratio) {
+        neo = new NeoOversampler(ratio, NEO_DEFAULT_STOPBAND, NEO_DEFAULT_TRANSITION, minimumPhase);
+    }
+
+
+    ~NeoCandidate() override {
+        delete neo;
+    }
+
+
+    void reset() override {
+        neo->reset();
+    }
+
+
+    float process(float x) override {
+        neo->upsample(x, buffer);
+
+        for (int i = 0; i < factor; i++) {
+            buffer[i] = clip(buffer[i]);
+        }
+
+        return neo->downsample(buffer);
+    }
+
+
+    double getLatency() override {
+        return neo->getLatency();
+    }
+};
+
+
+/**
+ * @brief All lanes get the same input, timing is reported per voice
+ */
+template<typename T>
+struct SIMDCandidate : Candidate {
+    SIMDResampler<T> *rs;
+
+
+    SIMDCandidate(const std::string &name, int oversample, int quality) : Candidate(name, oversample) {
+        rs = new SIMDResampler<T>(oversample, quality);
+        lanes = T::SIZE;
+    }
+
+
+    ~SIMDCandidate() override {
+        delete rs;
+    }
+
+
+    void reset() override {
+        rs->reset();
+    }
+
+
+    float process(float x) override {
+        rs->doUpsample(T(x));
+
+        T *up = rs->getUpsampled();
+        for (int i = 0; i < factor; i++) {
+            T y = simd::clampf(up[i] * CLIP_DRIVE, T(-1.f), T(1.f));
+            rs->data[i] = y;
+        }
+
+        return rs->getDownsampled()[0];
+    }
+
+
+    double getLatency() override {
+        return rs->getLatency();
+    }
+};
+
+
+/**
+ * @brief In place radix-2 FFT
+ */
+static void fft(std::complex<double> *x, int n) {
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+
+        if (i < j) std::swap(x[i], x[j]);
+    }
+
+    for (int len = 2; len <= n; len <<= 1) {
+        std::complex<double> wl(cos(-2. * M_PI / len), sin(-2. * M_PI / len));
+
+        for (int i = 0; i < n; i += len) {
+            std::complex<double> w(1.);
+
+            for (int j = 0; j < len / 2; j++) {
+                std::complex<double> u = x[i + j];
+                std::complex<double> v = x[i + j + len / 2] * w;
+
+                x[i + j] = u + v;
+                x[i + j + len / 2] = u - v;
+                w *= wl;
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Signal to alias ratio in dB for a tone on bin k (odd, so no alias hits a harmonic)
+ */
+static double measureSNR(Candidate *c, int k) {
+    std::vector<std::complex<double>> x(FFT_SIZE);
+
+    c->reset();
+
+    for (int n = 0; n < WARMUP + FFT_SIZE; n++) {
+        float y = c->process((float) sin(2. * M_PI * k * n / FFT_SIZE));
+        if (n >= WARMUP) x[n - WARMUP] = y;
+    }
+
+    fft(x.data(), FFT_SIZE);
+
+    double signal = 0., alias = 0.;
+
+    for (int i = 1; i < FFT_SIZE / 2; i++) {
+        double p = std::norm(x[i]);
+
+        if (i % k == 0) signal += p;
+        else alias += p;
+    }
+
+    return 10. * log10(signal / fmax(alias, 1e-30));
+}
+
+
+/**
+ * @brief Average processing time per sample (and voice) in nanoseconds
+ */
+static double measureTime(Candidate *c) {
+    volatile float sink = 0.f;
+    float phase = 0.f;
+
+    c->reset();
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int n = 0; n < TIMING_SAMPLES; n++) {
+        sink = sink + c->process(sinf(phase));
+        phase += 0.0123f;
+        if (phase > M_PI) phase -= 2.f * (float) M_PI;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+
+    return ns / TIMING_SAMPLES / c->lanes;
+}
+
+
+int main(int argc, char **argv) {
+    bool json = false;
+    double sr = 44100.;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) json = true;
+        else sr = atof(argv[i]);
+    }
+
+    std::vector<Candidate *> candidates = {
+            new DirectCandidate(),
+            new ResamplerCandidate("resampler-4x4", 4, 4, Resampler<1>::SINC),
+            new ResamplerCandidate("resampler-4x8", 4, 8, Resampler<1>::SINC),
+            new ResamplerCandidate("resampler-8x16", 8, 16, Resampler<1>::SINC),
+            new ResamplerCandidate("resampler-4x8-minphase", 4, 8, Resampler<1>::MINPHASE),
+            new ResamplerCandidate("resampler-8x16-minphase", 8, 16, Resampler<1>::MINPHASE),
+            new NeoCandidate("neo-2x", 2, false),
+            new NeoCandidate("neo-4x", 4, false),
+            new NeoCandidate("neo-8x", 8, false),
+            new NeoCandidate("neo-4x-minphase", 4, true),
+            new SIMDCandidate<float4>("simd4-4x8", 4, 8),
+            new SIMDCandidate<float8>("simd8-4x8", 4, 8),
+    };
+
+    /* odd bins, log spaced from about 100Hz up to 0.45 * samplerate */
+    std::vector<int> bins;
+    double lo = 100. / sr * FFT_SIZE, hi = 0.45 * FFT_SIZE;
+
+    for (int i = 0; i < TONES; i++) {
+        int k = ((int) (lo * pow(hi / lo, i / (TONES - 1.)))) | 1;
+        if (bins.empty() || k > bins.back()) bins.push_back(k);
+    }
+
+    if (json) printf("{\n  \"samplerate\": %g,\n  \"results\": [\n", sr);
+    else printf("%-26s %6s %9s %10s %10s %10s\n", "config", "factor", "latency", "ns/sample", "snr min", "snr mean");
+
+    for (size_t ci = 0; ci < candidates.size(); ci++) {
+        Candidate *c = candidates[ci];
+
+        std::vector<double> snr;
+        for (int k : bins) snr.push_back(measureSNR(c, k));
+
+        double ns = measureTime(c);
+        double min = snr[0], mean = 0.;
+
+        for (double s : snr) {
+            min = fmin(min, s);
+            mean += s / snr.size();
+        }
+
+        if (json) {
+            printf("    {\"name\": \"%s\", \"factor\": %d, \"lanes\": %d, \"latency\": %.3f, \"ns_per_sample\": %.3f, "
+                   "\"snr_min\": %.2f, \"snr_mean\": %.2f, \"snr\": [",
+                   c->name.c_str(), c->factor, c->lanes, c->getLatency(), ns, min, mean);
+
+            for (size_t i = 0; i < bins.size(); i++) {
+                printf("%s{\"hz\": %.1f, \"db\": %.2f}", i ? ", " : "", bins[i] * sr / FFT_SIZE, snr[i]);
+            }
+
+            printf("]}%s\n", ci + 1 < candidates.size() ? "," : "");
+        } else {
+            printf("%-26s %6d %9.2f %10.2f %10.2f %10.2f\n", c->name.c_str(), c->factor, c->getLatency(), ns, min, mean);
+        }
+
+        delete c;
+    }
+
+    if (json) printf("  ]\n}\n");
+
+    return 0;
+}
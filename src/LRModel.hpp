@@ -35,6 +35,8 @@ static const char *const JSON_PATINA_A_Y = "patina_a_y";
 static const char *const JSON_PATINA_B_X = "patina_b_x";
 static const char *const JSON_PATINA_B_Y = "patina_b_y";
 
+static const char *const JSON_AUDIORATE_KEY = "audiorate";
+
 static const string STR_CHECKMARK_UNICODE = "✔";
 
 // forward declaration
@@ -49,6 +51,13 @@ struct LRModule : Module {
     // reflect back to push events to UI
     LRModuleWidget *reflect;
 
+    /* control rate in samples, modules opt in with setControlRate() - 1 reads all CV at audio rate */
+    int controlRate = 1;
+    int controlCounter = 0;
+
+    /* forces audio rate on modules with a control rate, e.g. for FM-style cutoff modulation */
+    bool audioRate = false;
+
     /**
      * @brief Default constructor derived from rack
      * @param numParams
@@ -59,6 +68,48 @@ struct LRModule : Module {
     explicit LRModule(int numParams, int numInputs, int numOutputs, int numLights);
 
     void onRandomize() override;
+    json_t *dataToJson() override;
+    void dataFromJson(json_t *rootJ) override;
+
+
+    /**
+     * @brief Read CV and compute coefficients only every n samples, engines ramp in between
+     * @param samples Control rate in samples, e.g. 16 or 32
+     */
+    void setControlRate(int samples) {
+        controlRate = samples < 1 ? 1 : samples;
+    }
+
+
+    /**
+     * @brief Effective control rate, 1 if audio rate is forced
+     * @return
+     */
+    int getControlRate() const {
+        return audioRate ? 1 : controlRate;
+    }
+
+
+    /**
+     * @brief Call once per process(), true on every block boundary of the control rate
+     * @return
+     */
+    bool isControlTick() {
+        if (--controlCounter > 0) return false;
+
+        controlCounter = getControlRate();
+        return true;
+    }
+
+
+    /**
+     * @brief Processing latency in samples, e.g. caused by oversampling. Shown in the context menu
+     * so parallel paths can be compensated.
+     * @return
+     */
+    virtual double getLatency() {
+        return 0.;
+    }
 };
 
 
@@ -171,6 +222,27 @@ struct LRModuleWidget : ModuleWidget {
     };
 
 
+    /**
+     * @brief Toggles audio rate modulation on modules with a control rate
+     */
+    struct AudioRateItem : MenuItem {
+        LRModule *module;
+
+
+        explicit AudioRateItem(LRModule *module) : module(module) {}
+
+
+        void onAction(const event::Action &e) override {
+            module->audioRate = !module->audioRate;
+        }
+
+
+        void step() override {
+            rightText = module->audioRate ? STR_CHECKMARK_UNICODE : "";
+        }
+    };
+
+
     virtual void onRandomize() {
         panel->patinaWidgetClassic->randomize();
         panel->patinaWidgetWhite->randomize();
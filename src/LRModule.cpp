@@ -39,4 +39,26 @@ void LRModule::onRandomize() {
 }
 
 
+/**
+ * @brief Save the settings shared by all modules, subclasses add their own keys to the returned object
+ * @return
+ */
+json_t *LRModule::dataToJson() {
+    json_t *rootJ = json_object();
+    json_object_set_new(rootJ, JSON_AUDIORATE_KEY, json_boolean(audioRate));
+
+    return rootJ;
+}
+
+
+/**
+ * @brief Load the settings shared by all modules
+ * @param rootJ
+ */
+void LRModule::dataFromJson(json_t *rootJ) {
+    json_t *audioRateJ = json_object_get(rootJ, JSON_AUDIORATE_KEY);
+    audioRate = audioRateJ ? json_is_true(audioRateJ) : false;
+}
+
+
 
@@ -27,6 +27,20 @@ void LRModuleWidget::appendContextMenu(ui::Menu *menu) {
 
     auto count = panel->pool.size() - 1; // NIL does not count!
 
+    auto *lrmodule = dynamic_cast<LRModule *>(module);
+
+    if (lrmodule != nullptr && lrmodule->getLatency() > 0.) {
+        auto *latencyLabel = new MenuLabel();
+        latencyLabel->text = "Latency: " + rack::string::f("%.1f", lrmodule->getLatency()) + " samples";
+        menu->addChild(latencyLabel);
+    }
+
+    if (lrmodule != nullptr && lrmodule->controlRate > 1) {
+        auto *audioRateItem = new AudioRateItem(lrmodule);
+        audioRateItem->text = "Audio Rate Modulation";
+        menu->addChild(audioRateItem);
+    }
+
     if (isPreview || noVariants) return; // if gestalt is disabled do nothing
 
     auto *spacerLabel = new MenuLabel();
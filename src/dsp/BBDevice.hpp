@@ -17,6 +17,7 @@
 \*                                                                     */
 #pragma once
 
+#include <vector>
 #include "DSPEffect.hpp"
 
 namespace lrt {
@@ -52,25 +52,25 @@ lrt::Biquad::~Biquad() {
 
 void lrt::Biquad::setType(BiquadType type) {
     this->type = type;
-    invalidate();
+    markDirty();
 }
 
 
 void lrt::Biquad::setQ(double Q) {
     this->Q = Q;
-    invalidate();
+    markDirty();
 }
 
 
 void lrt::Biquad::setFc(double Fc) {
     this->Fc = Fc;
-    invalidate();
+    markDirty();
 }
 
 
 void lrt::Biquad::setPeakGain(double peakGainDB) {
     this->peakGain = peakGainDB;
-    invalidate();
+    markDirty();
 }
 
 
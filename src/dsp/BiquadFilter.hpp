@@ -49,6 +49,7 @@ public:
 
     void setBiquad(BiquadType type, double Fc, double Q, double peakGain);
     void process() override;
+    void processBlock(const float *in, float *out, int frames);
     void invalidate() override;
     void init() override;
     double in, out;
@@ -64,10 +65,34 @@ protected:
 
 
 inline void Biquad::process() {
+    update();
+
     out = in * a0 + z1;
     z1 = in * a1 + z2 - b1 * out;
     z2 = in * a2 - b2 * out;
 }
 
 
+inline void Biquad::processBlock(const float *in, float *out, int frames) {
+    update();
+
+    /* keep the state in registers for the whole block */
+    double s1 = z1, s2 = z2, y = Biquad::out;
+
+    for (int i = 0; i < frames; i++) {
+        double x = in[i];
+
+        y = x * a0 + s1;
+        s1 = x * a1 + s2 - b1 * y;
+        s2 = x * a2 - b2 * y;
+
+        out[i] = (float) y;
+    }
+
+    z1 = s1;
+    z2 = s2;
+    Biquad::out = y;
+}
+
+
 }
@@ -0,0 +1,71 @@
+/*                                                                     *\
+**       __   ___  ______                                              **
+**      / /  / _ \/_  __/                                              **
+**     / /__/ , _/ / /    Lindenberg                                   **
+**    /____/_/|_| /_/  Research Tec.                                   **
+**                                                                     **
+**                                                                     **
+**	  https://github.com/lindenbergresearch/LRTRack	                   **
+**    heapdump@icloud.com                                              **
+**		                                                               **
+**    Sound Modules for VCV Rack                                       **
+**    Copyright 2017-2019 by Patrick Lindenberg / LRT                  **
+**                                                                     **
+**    For Redistribution and use in source and binary forms,           **
+**    with or without modification please see LICENSE.                 **
+**                                                                     **
+\*                                                                     */
+#include <cmath>
+#include <mutex>
+#include <vector>
+#include "CutoffTable.hpp"
+#include "DSPMath.hpp"
+
+namespace lrt {
+
+CutoffTable::CutoffTable(float base, float offset, float sr) : base(base), offset(offset), sr(sr) {
+    auto *hzt = new float[SIZE + 1];
+    auto *gt = new float[SIZE + 1];
+    auto *Gt = new float[SIZE + 1];
+
+    /* computed in double, the table is the reference for every filter at this rate */
+    for (int i = 0; i <= SIZE; i++) {
+        double fc = (double) MAX_CUTOFF * i / SIZE;
+        double f = MIN_FREQUENCY * pow((double) base, fc) + offset;
+        double w = fmin(fmax(M_PI * f / sr, 0.), MAX_ANGLE * M_PI);
+        double x = tan(w);
+
+        hzt[i] = (float) f;
+        gt[i] = (float) x;
+        Gt[i] = (float) (x / (1. + x));
+    }
+
+    hz = hzt;
+    g = gt;
+    G = Gt;
+}
+
+
+float CutoffTable::prewarp(float hz, float sr) {
+    float w = clampf((float) M_PI * hz / sr, 0.f, MAX_ANGLE * (float) M_PI);
+    return fastTan(w);
+}
+
+
+const CutoffTable *CutoffTable::get(float base, float offset, float sr) {
+    static std::mutex lock;
+    static std::vector<const CutoffTable *> tables;
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    for (auto t : tables) {
+        if (t->base == base && t->offset == offset && t->sr == sr) return t;
+    }
+
+    auto t = new CutoffTable(base, offset, sr);
+    tables.push_back(t);
+
+    return t;
+}
+
+}
@@ -0,0 +1,118 @@
+/*                                                                     *\
+**       __   ___  ______                                              **
+**      / /  / _ \/_  __/                                              **
+**     / /__/ , _/ / /    Lindenberg                                   **
+**    /____/_/|_| /_/  Research Tec.                                   **
+**                                                                     **
+**                                                                     **
+**	  https://github.com/lindenbergresearch/LRTRack	                   **
+**    heapdump@icloud.com                                              **
+**		                                                               **
+**    Sound Modules for VCV Rack                                       **
+**    Copyright 2017-2019 by Patrick Lindenberg / LRT                  **
+**                                                                     **
+**    For Redistribution and use in source and binary forms,           **
+**    with or without modification please see LICENSE.                 **
+**                                                                     **
+\*                                                                     */
+#pragma once
+
+#include <cmath>
+
+namespace lrt {
+
+/**
+ * @brief Shared, read-only table mapping a normalized cutoff straight to the prewarped TPT coefficients
+ *
+ * The cutoff is mapped exponentially to Hz = MIN_FREQUENCY * base^fc + offset and prewarped with the
+ * bilinear transform: g = tan(PI * Hz / sr) and G = g / (1 + g). Tables are looked up by (base, offset, sr)
+ * and created only once per process, so all filters at the same rate share one table. Cutoff values
+ * outside 0..MAX_CUTOFF are computed directly with fastTan().
+ */
+struct CutoffTable {
+    static const int SIZE = 1024;                   // number of intervals, interpolated linear
+    static constexpr float MAX_CUTOFF = 1.1f;       // upper end of the table
+    static constexpr float MIN_FREQUENCY = 20.f;    // frequency at cutoff 0 without offset
+    static constexpr float MAX_ANGLE = 0.49f;       // prewarp limit relative to PI, keeps tan() finite
+
+    float base, offset, sr;
+
+    /* SIZE + 1 entries each, the last one holds MAX_CUTOFF */
+    const float *hz;
+    const float *g;
+    const float *G;
+
+
+    /**
+     * @brief Get the shared table for a mapping and samplerate, creates it on first use
+     * @param base Base of the exponential mapping, e.g. 1000 for 20Hz..20kHz
+     * @param offset Offset in Hz added after the mapping
+     * @param sr Samplerate the filter runs at (including oversampling)
+     * @return
+     */
+    static const CutoffTable *get(float base, float offset, float sr);
+
+
+    /**
+     * @brief Bilinear prewarp of a frequency, g = tan(PI * hz / sr)
+     * @param hz Frequency
+     * @param sr Samplerate
+     * @return
+     */
+    static float prewarp(float hz, float sr);
+
+
+    /**
+     * @brief Cutoff frequency in Hz
+     * @param fc Normalized cutoff
+     * @return
+     */
+    inline float getHz(float fc) const {
+        return inRange(fc) ? lookup(hz, fc) : MIN_FREQUENCY * powf(base, fc) + offset;
+    }
+
+
+    /**
+     * @brief Prewarped cutoff g
+     * @param fc Normalized cutoff
+     * @return
+     */
+    inline float getG(float fc) const {
+        return inRange(fc) ? lookup(g, fc) : prewarp(getHz(fc), sr);
+    }
+
+
+    /**
+     * @brief One pole gain G = g / (1 + g)
+     * @param fc Normalized cutoff
+     * @return
+     */
+    inline float getGain(float fc) const {
+        if (inRange(fc)) return lookup(G, fc);
+
+        float x = getG(fc);
+        return x / (1.f + x);
+    }
+
+private:
+    CutoffTable(float base, float offset, float sr);
+
+
+    static inline bool inRange(float fc) {
+        return fc >= 0.f && fc <= MAX_CUTOFF;
+    }
+
+
+    static inline float lookup(const float *t, float fc) {
+        float x = fc * (SIZE / MAX_CUTOFF);
+        int i = (int) x;
+
+        /* fc == MAX_CUTOFF lands on the last entry */
+        if (i >= SIZE) return t[SIZE];
+
+        float f = x - i;
+        return t[i] + (t[i + 1] - t[i]) * f;
+    }
+};
+
+}
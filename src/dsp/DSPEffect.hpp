@@ -1,10 +1,16 @@
 #pragma once
 
 #include <string.h>
-#include "dsp/ringbuffer.hpp"
+#include <cmath>
+#include "ResamplerKernel.hpp"
 
-#define RS_BUFFER_SIZE 512
 #define UPSAMPLE_COMPENSATION 1.3
+#define RS_BLOCK_SIZE 64
+#define ADAPTIVE_HOLD_BLOCKS 8
+#define ADAPTIVE_HARMONICS 16.
+#define ADAPTIVE_BANDWIDTH (M_PI * 0.5)
+#define ADAPTIVE_SILENCE 1e-4
+#define ADAPTIVE_RELEASE 0.9
 
 
 namespace lrt {
@@ -14,6 +20,14 @@ namespace lrt {
  */
 struct DSPEffect {
 
+protected:
+
+    /* set on parameter changes, the next update() recomputes the coefficients */
+    bool dirty = true;
+
+    /* length of the coefficient ramps started by invalidate(), 1 means immediate (audio rate) */
+    int rampLength = 1;
+
 public:
 
     float sr = 44100.0;
@@ -24,6 +38,9 @@ public:
     }
 
 
+    virtual ~DSPEffect() {}
+
+
     float getSamplerate() const {
         return sr;
     }
@@ -44,11 +61,52 @@ public:
     virtual void invalidate() {};
 
 
+    /**
+     * @brief Mark parameters as changed, invalidate() is deferred to the next update()
+     */
+    void markDirty() {
+        dirty = true;
+    }
+
+
+    /**
+     * @brief Run invalidate() once if any parameter changed since the last call
+     */
+    void update() {
+        if (dirty) {
+            dirty = false;
+            invalidate();
+        }
+    }
+
+
+    /**
+     * @brief Set the length of the coefficient ramps, usually the control rate of the calling module
+     * @param samples Number of samples, 1 switches to audio rate
+     */
+    void setRampLength(int samples) {
+        rampLength = samples < 1 ? 1 : samples;
+    }
+
+
     /**
      * @brief Process one step and return the computed sample
+     *
+     * Engines with an audio input add `void processBlock(const float *in, float *out, int frames)`,
+     * which shares the state with process(). There is no default, an engine without a block path
+     * does not compile instead of returning nothing.
      * @return
      */
     virtual void process() {};
+
+
+    /**
+     * @brief Processing latency in samples at the host rate, e.g. caused by oversampling
+     * @return
+     */
+    virtual double getLatency() {
+        return 0.;
+    }
 };
 
 
@@ -87,51 +145,126 @@ inline void blackmanHarrisWindow(double *x, int len) {
 
 
 struct Decimator {
-    double inBuffer[RS_BUFFER_SIZE];
-    double kernel[RS_BUFFER_SIZE];
+    double *inBuffer;
+    double *work;
+    const double *kernel;
     int inIndex;
-    int oversample, quality;
+    int oversample, quality, length;
     double cutoff = 0.65;
 
 
-    Decimator(int oversample, int quality) {
+    /* group delay in samples at the oversampled rate */
+    double delay;
+
+
+    Decimator(int oversample, int quality, bool minimumPhase = false) {
+        auto k = ResamplerKernel::get(oversample, quality, cutoff, minimumPhase);
+
         Decimator::oversample = oversample;
         Decimator::quality = quality;
+        length = k->length;
+        delay = k->delay;
+
+        /* shared time-reversed kernel, so the convolution runs forward over the history */
+        kernel = k->reversed;
+
+        /* mirrored history, holds exactly two kernel lengths */
+        inBuffer = new double[2 * length];
+
+        /* linear history plus one block for processBlock() */
+        work = new double[length + RS_BLOCK_SIZE * oversample];
 
-        boxcarLowpassIR(kernel, oversample * quality, cutoff * 0.5 / oversample);
-        blackmanHarrisWindow(kernel, oversample * quality);
         reset();
     }
 
 
+    ~Decimator() {
+        delete[] inBuffer;
+        delete[] work;
+    }
+
+
+    Decimator(const Decimator &) = delete;
+    Decimator &operator=(const Decimator &) = delete;
+
+
     void reset() {
         inIndex = 0;
-        memset(inBuffer, 0, sizeof(inBuffer));
+        memset(inBuffer, 0, 2 * length * sizeof(double));
     }
 
 
     /** `in` must be length OVERSAMPLE */
-    float process(double *in) {
-        // Copy input to buffer
-        memcpy(&inBuffer[inIndex], in, oversample * sizeof(double));
+    float process(const float *in) {
+        // Copy input to the mirrored buffer, so the last `length` samples are always contiguous
+        for (int i = 0; i < oversample; i++) {
+            inBuffer[inIndex + i] = in[i];
+            inBuffer[inIndex + length + i] = in[i];
+        }
+
         // Advance index
         inIndex += oversample;
-        inIndex %= oversample * quality;
-        // Perform naive convolution
+        if (inIndex >= length) inIndex = 0;
+
+        // Plain dot product, x[0] is the oldest sample
+        const double *x = &inBuffer[inIndex];
         double out = 0.;
-        for (int i = 0; i < oversample * quality; i++) {
-            int index = inIndex - 1 - i;
-            index = (index + oversample * quality) % (oversample * quality);
-            out += kernel[i] * inBuffer[index];
+
+        for (int i = 0; i < length; i++) {
+            out += kernel[i] * x[i];
         }
+
         return out;
     }
+
+
+    /**
+     * @brief Decimate a block, same result as calling process() n times
+     *
+     * The history and the whole block are laid out linearly once, so every output is a plain dot
+     * product without maintaining the mirrored buffer per sample.
+     * @param in Oversampled input, must be length n * OVERSAMPLE
+     * @param n Number of output samples
+     * @param out Output samples
+     */
+    void processBlock(const float *in, int n, float *out) {
+        while (n > 0) {
+            int frames = n < RS_BLOCK_SIZE ? n : RS_BLOCK_SIZE;
+            int samples = frames * oversample;
+
+            memcpy(work, &inBuffer[inIndex], length * sizeof(double));
+
+            for (int i = 0; i < samples; i++) {
+                work[length + i] = in[i];
+            }
+
+            for (int k = 0; k < frames; k++) {
+                const double *x = &work[(k + 1) * oversample];
+                double y = 0.;
+
+                for (int i = 0; i < length; i++) {
+                    y += kernel[i] * x[i];
+                }
+
+                out[k] = (float) y;
+            }
+
+            /* store the last `length` samples back, oldest first */
+            inIndex = 0;
+            memcpy(inBuffer, &work[samples], length * sizeof(double));
+            memcpy(inBuffer + length, &work[samples], length * sizeof(double));
+
+            in += samples;
+            out += frames;
+            n -= frames;
+        }
+    }
 };
 
 
 struct Upsampler {
-    double inBuffer[RS_BUFFER_SIZE];
-    double kernel[RS_BUFFER_SIZE];
+    double *inBuffer;
+    const double *kernel;
     int inIndex;
     int oversample, quality;
     double cutoff = 0.65;
@@ -141,15 +274,25 @@ struct Upsampler {
         Upsampler::oversample = oversample;
         Upsampler::quality = quality;
 
-        boxcarLowpassIR(kernel, oversample * quality, cutoff * 0.5 / oversample);
-        blackmanHarrisWindow(kernel, oversample * quality);
+        kernel = ResamplerKernel::get(oversample, quality, cutoff)->ir;
+        inBuffer = new double[quality];
+
         reset();
     }
 
 
+    ~Upsampler() {
+        delete[] inBuffer;
+    }
+
+
+    Upsampler(const Upsampler &) = delete;
+    Upsampler &operator=(const Upsampler &) = delete;
+
+
     void reset() {
         inIndex = 0;
-        memset(inBuffer, 0, sizeof(inBuffer));
+        memset(inBuffer, 0, quality * sizeof(double));
     }
 
 
@@ -161,7 +304,7 @@ struct Upsampler {
         inIndex++;
         inIndex %= quality;
         // Naively convolve each sample
-        // TODO replace with polyphase lpf hierarchy
+        // see PolyphaseUpsampler for the polyphase version used by Resampler
         for (int i = 0; i < oversample; i++) {
             float y = 0.0;
             for (int j = 0; j < quality; j++) {
@@ -176,6 +319,131 @@ struct Upsampler {
 };
 
 
+/**
+ * @brief Polyphase interpolator
+ *
+ * The lowpass kernel is split up into one sub-filter per output phase, so every phase only convolves
+ * the actual input samples instead of the zero-stuffed stream. The history is mirrored (each sample is
+ * written twice) which keeps the last `quality` samples contiguous and avoids any modulo indexing.
+ */
+struct PolyphaseUpsampler {
+    double *inBuffer;
+    double *work;
+    const double *phases;
+    int inIndex;
+    int oversample, quality, taps;
+    double cutoff = 0.65;
+
+    /* group delay in samples at the oversampled rate */
+    double delay;
+
+
+    PolyphaseUpsampler(int oversample, int quality, bool minimumPhase = false) {
+        auto k = ResamplerKernel::get(oversample, quality, cutoff, minimumPhase);
+
+        PolyphaseUpsampler::oversample = oversample;
+        PolyphaseUpsampler::quality = quality;
+        taps = k->taps;
+        delay = k->delay;
+
+        /* sub-filter i holds every oversample-th tap starting at i, stored time-reversed (oldest sample first) */
+        phases = k->phases;
+        inBuffer = new double[2 * taps];
+
+        /* linear history plus one block for processBlock() */
+        work = new double[taps + RS_BLOCK_SIZE];
+
+        reset();
+    }
+
+
+    ~PolyphaseUpsampler() {
+        delete[] inBuffer;
+        delete[] work;
+    }
+
+
+    PolyphaseUpsampler(const PolyphaseUpsampler &) = delete;
+    PolyphaseUpsampler &operator=(const PolyphaseUpsampler &) = delete;
+
+
+    void reset() {
+        inIndex = 0;
+        memset(inBuffer, 0, 2 * taps * sizeof(double));
+    }
+
+
+    /** `out` must be length OVERSAMPLE */
+    void process(double in, float *out) {
+        // Write input twice to keep a linear view of the history
+        inBuffer[inIndex] = oversample * in;
+        inBuffer[inIndex + taps] = oversample * in;
+
+        // Advance index
+        if (++inIndex >= taps) inIndex = 0;
+
+        // x[0] is the oldest and x[taps - 1] the newest sample
+        const double *x = &inBuffer[inIndex];
+
+        for (int i = 0; i < oversample; i++) {
+            const double *h = &phases[i * taps];
+            double y = 0.;
+
+            for (int j = 0; j < taps; j++) {
+                y += h[j] * x[j];
+            }
+
+            out[i] = (float) y;
+        }
+    }
+
+
+    /**
+     * @brief Upsample a block, same result as calling process(in[i] * gain) n times
+     * @param in Input samples
+     * @param n Number of input samples
+     * @param out Upsampled output, must be length n * OVERSAMPLE
+     * @param gain Applied to the input
+     */
+    void processBlock(const float *in, int n, float *out, double gain = 1.) {
+        while (n > 0) {
+            int frames = n < RS_BLOCK_SIZE ? n : RS_BLOCK_SIZE;
+
+            memcpy(work, &inBuffer[inIndex], taps * sizeof(double));
+
+            for (int k = 0; k < frames; k++) {
+                work[taps + k] = oversample * (in[k] * gain);
+            }
+
+            for (int k = 0; k < frames; k++) {
+                const double *x = &work[k + 1];
+
+                for (int i = 0; i < oversample; i++) {
+                    const double *h = &phases[i * taps];
+                    double y = 0.;
+
+                    for (int j = 0; j < taps; j++) {
+                        y += h[j] * x[j];
+                    }
+
+                    out[i] = (float) y;
+                }
+
+                out += oversample;
+            }
+
+            /* store the last `taps` samples back, oldest first */
+            inIndex = 0;
+            memcpy(inBuffer, &work[frames], taps * sizeof(double));
+            memcpy(inBuffer + taps, &work[frames], taps * sizeof(double));
+
+            in += frames;
+            n -= frames;
+        }
+    }
+};
+
+
 /**
  * @brief NEW oversampling class
  */
@@ -185,35 +453,102 @@ struct Resampler {
         double y0, y1;
     };
 
+    /**
+     * @brief Available filter engines
+     */
+    enum Type {
+        SINC,       // single windowed-sinc kernel at the oversampled rate
+        MINPHASE    // minimum phase version of SINC, less taps and far less latency
+    };
+
     Vector y[CHANNELS] = {};
-    double up[CHANNELS][RS_BUFFER_SIZE] = {};
-    double data[CHANNELS][RS_BUFFER_SIZE] = {};
 
-    Decimator *decimator[CHANNELS];
-    Upsampler *interpolator[CHANNELS];
+    /* oversampled frames, one factor long per channel */
+    float *up[CHANNELS];
+    float *data[CHANNELS];
+
+    Decimator *decimator[CHANNELS] = {};
+    PolyphaseUpsampler *interpolator[CHANNELS] = {};
+
+    /* scratch buffer for block processing, RS_BLOCK_SIZE * oversample samples */
+    float *block;
+
+    /* single allocation backing up, data and block */
+    float *memory;
 
     int oversample;
+    Type type;
 
 
     /**
      * @brief Constructor
      * @param factor Oversampling factor
+     * @param quality Kernel length per sample
+     * @param type Filter engine
      */
-    Resampler(int oversample, int quality = 4) {
+    Resampler(int oversample, int quality = 4, Type type = SINC) {
         Resampler::oversample = oversample;
+        Resampler::type = type;
 
         for (int i = 0; i < CHANNELS; i++) {
-            decimator[i] = new Decimator(oversample, quality);
-            interpolator[i] = new Upsampler(oversample, quality);
+            decimator[i] = new Decimator(oversample, quality, type == MINPHASE);
+            interpolator[i] = new PolyphaseUpsampler(oversample, quality, type == MINPHASE);
         }
+
+        /* size everything from the actual factor, so small resamplers stay small */
+        memory = new float[(2 * CHANNELS + RS_BLOCK_SIZE) * oversample]();
+
+        for (int i = 0; i < CHANNELS; i++) {
+            up[i] = memory + i * oversample;
+            data[i] = memory + (CHANNELS + i) * oversample;
+        }
+
+        block = memory + 2 * CHANNELS * oversample;
+    }
+
+
+    ~Resampler() {
+        for (int i = 0; i < CHANNELS; i++) {
+            delete decimator[i];
+            delete interpolator[i];
+        }
+
+        delete[] memory;
     }
 
 
+    Resampler(const Resampler &) = delete;
+    Resampler &operator=(const Resampler &) = delete;
+
+
     int getFactor() {
         return oversample;
     }
 
 
+    /**
+     * @brief Group delay of the upsample -> decimate path in samples at the host rate
+     * @return
+     */
+    double getLatency() {
+        /* the decimator picks the last sample of every frame, which saves oversample - 1 samples */
+        return (interpolator[0]->delay + decimator[0]->delay - (oversample - 1)) / oversample;
+    }
+
+
+    /**
+     * @brief Clear all filter histories
+     */
+    void reset() {
+        for (int i = 0; i < CHANNELS; i++) {
+            decimator[i]->reset();
+            interpolator[i]->reset();
+        }
+
+        memset(memory, 0, (2 * CHANNELS + RS_BLOCK_SIZE) * oversample * sizeof(float));
+    }
+
+
     /**
      * @brief Return linear interpolated position
      * @param point Point in oversampled data
@@ -253,9 +588,269 @@ struct Resampler {
      * @param channel Channel to retrieve
      * @return Pointer to the upsampled data
      */
-    double *getUpsampled(int channel) {
+    float *getUpsampled(int channel) {
         return up[channel];
     }
+
+
+    /**
+     * @brief Returns the scratch buffer for block processing, holds RS_BLOCK_SIZE * factor samples
+     * @return
+     */
+    float *getBlockBuffer() {
+        return block;
+    }
+
+
+    /**
+     * @brief Upsample a block of samples
+     * @param channel Channel to process
+     * @param in Input samples at host rate
+     * @param n Number of input samples
+     * @param osOut Upsampled output, must be length n * factor
+     */
+    void upsampleBlock(int channel, const float *in, int n, float *osOut) {
+        interpolator[channel]->processBlock(in, n, osOut, UPSAMPLE_COMPENSATION);
+    }
+
+
+    /**
+     * @brief Decimate a block of oversampled samples
+     * @param channel Channel to process
+     * @param osIn Oversampled input, must be length n * factor
+     * @param n Number of output samples
+     * @param out Output samples at host rate
+     */
+    void decimateBlock(int channel, const float *osIn, int n, float *out) {
+        decimator[channel]->processBlock(osIn, n, out);
+    }
+};
+
+
+/**
+ * @brief Per block selection between the oversampled and the direct (1x) path of a shaper
+ *
+ * Tracks peak and slope of the input with a slow release, the owner decides from these (and its gain settings) if the
+ * block needs oversampling. Switching up happens at once, switching down only after the signal
+ * stayed harmless for ADAPTIVE_HOLD_BLOCKS blocks. Both paths are crossfaded over one block and the
+ * direct path is delayed by the latency of the resampler, so they line up during the fade. The input
+ * history is kept long enough to warm up the resampler before it is switched on again.
+ *
+ * Both paths keep their own state of the shaper (e.g. antiderivative antialiasing), the owner resets
+ * the state of the direct path when it fades in again (see isDirectStarting()).
+ */
+struct AdaptiveOversampling {
+    Resampler<1> *rs;
+
+    double peak, slope, last;
+
+    /* weight of the oversampled path, 0 = direct only, 1 = oversampled only */
+    double mix;
+    bool active;
+    int pos, hold;
+
+    /* direct path computed on the last sample */
+    bool directRunning;
+
+    /* input history, holds at least `warmup` samples */
+    double *delayLine;
+    int delaySize, delayIndex;
+    int latency, warmup;
+
+
+    explicit AdaptiveOversampling(Resampler<1> *rs) {
+        AdaptiveOversampling::rs = rs;
+
+        /* the filters span about twice their group delay */
+        latency = (int) lround(rs->getLatency());
+        warmup = 2 * latency + 2;
+
+        delaySize = warmup + 1;
+        delayLine = new double[delaySize];
+
+        reset();
+    }
+
+
+    ~AdaptiveOversampling() {
+        delete[] delayLine;
+    }
+
+
+    AdaptiveOversampling(const AdaptiveOversampling &) = delete;
+    AdaptiveOversampling &operator=(const AdaptiveOversampling &) = delete;
+
+
+    void reset() {
+        peak = 0;
+        slope = 0;
+        last = 0;
+        mix = 0;
+        active = false;
+        directRunning = false;
+        pos = 0;
+        hold = 0;
+        delayIndex = 0;
+
+        memset(delayLine, 0, delaySize * sizeof(double));
+    }
+
+
+    /**
+     * @brief Update peak and slope with the next input sample
+     * @param x
+     */
+    inline void analyze(double x) {
+        double d = fabs(x - last);
+        double a = fabs(x);
+
+        last = x;
+
+        if (a > peak) peak = a;
+        if (d > slope) slope = d;
+    }
+
+
+    /**
+     * @brief Check if the owner has to provide a decision for the current sample. Up-switching is
+     * checked on every sample, down-switching only at the end of a block.
+     * @return
+     */
+    inline bool isDecisionPending() {
+        return !active || pos == RS_BLOCK_SIZE - 1;
+    }
+
+
+    /**
+     * @brief Select the path, has to be called if isDecisionPending() returns true
+     * @param needed True if the current block needs oversampling
+     * @return True if the oversampled path was switched on, the owner should then feed the last
+     * `warmup` inputs (see getHistory()) through it before processing the current sample
+     */
+    inline bool decide(bool needed) {
+        bool started = false;
+
+        if (needed) {
+            /* start with a clean history, the filters may hold stale data from the last active period */
+            if (!isOversampled()) {
+                rs->reset();
+                started = true;
+            }
+
+            active = true;
+            hold = ADAPTIVE_HOLD_BLOCKS;
+        } else if (active && pos == RS_BLOCK_SIZE - 1 && --hold <= 0) {
+            active = false;
+        }
+
+        return started;
+    }
+
+
+    /**
+     * @brief Past input sample, valid before delay() is called for the current sample
+     * @param i Distance in samples, 1 is the last input
+     * @return
+     */
+    inline double getHistory(int i) {
+        int index = delayIndex - i;
+        if (index < 0) index += delaySize;
+
+        return delayLine[index];
+    }
+
+
+    /**
+     * @brief Generic estimate for a static curve: driven by `drive` (1 = knee of the curve) it creates
+     * harmonics up to about ADAPTIVE_HARMONICS * drive times the input frequency. The frequency is
+     * estimated from slope and peak, oversampling is needed if the harmonics exceed ADAPTIVE_BANDWIDTH.
+     * @param drive Drive of the current block relative to the knee of the curve
+     * @return
+     */
+    inline bool isAliasing(double drive) {
+        if (peak < ADAPTIVE_SILENCE) return false;
+
+        double w = fmin(slope / peak, M_PI);
+
+        return w * (1. + ADAPTIVE_HARMONICS * drive) > ADAPTIVE_BANDWIDTH;
+    }
+
+
+    /**
+     * @brief Advance crossfade and block position, call once per sample after both paths are computed
+     */
+    inline void next() {
+        directRunning = isDirect();
+
+        if (active) {
+            mix = fmin(mix + 1. / RS_BLOCK_SIZE, 1.);
+        } else {
+            mix = fmax(mix - 1. / RS_BLOCK_SIZE, 0.);
+        }
+
+        /* let the estimates decay instead of clearing them, a single block may only see a part of a period */
+        if (++pos >= RS_BLOCK_SIZE) {
+            pos = 0;
+            peak *= ADAPTIVE_RELEASE;
+            slope *= ADAPTIVE_RELEASE;
+        }
+    }
+
+
+    /**
+     * @brief Delay the input of the direct path by the latency of the resampler
+     * @param x
+     * @return
+     */
+    inline double delay(double x) {
+        delayLine[delayIndex] = x;
+        if (++delayIndex >= delaySize) delayIndex = 0;
+
+        return getHistory(latency + 1);
+    }
+
+
+    /**
+     * @brief True if the oversampled path has to be computed
+     */
+    inline bool isOversampled() {
+        return active || mix > 0.;
+    }
+
+
+    /**
+     * @brief True if the direct path has to be computed
+     */
+    inline bool isDirect() {
+        return mix < 1.;
+    }
+
+
+    /**
+     * @brief True if the direct path is computed again after it was faded out, its state is stale then
+     */
+    inline bool isDirectStarting() {
+        return isDirect() && !directRunning;
+    }
+
+
+    /**
+     * @brief Past input of the direct path, valid after delay() is called for the current sample
+     * @param i Distance in samples, 1 is the direct input of the last sample, up to latency + 2
+     * @return
+     */
+    inline double getDirectHistory(int i) {
+        return getHistory(latency + 1 + i);
+    }
+
+
+    /**
+     * @brief Factor of the path which is currently in use, for metering
+     * @return
+     */
+    int getFactor() {
+        return isOversampled() ? rs->getFactor() : 1;
+    }
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,685 @@
+/*                                                                     *\
+**       __   ___  ______                                              **
+**      / /  / _ \/_  __/                                              **
+**     / /__/ , _/ / /    Lindenberg                                   **
+**    /____/_/|_| /_/  Research Tec.                                   **
+**                                                                     **
+**                                                                     **
+**	  https://github.com/lindenbergresearch/LRTRack	                   **
+**    heapdump@icloud.com                                              **
+**		                                                               **
+**    Sound Modules for VCV Rack                                       **
+**    Copyright 2017-2019 by Patrick Lindenberg / LRT                  **
+**                                                                     **
+**    For Redistribution and use in source and binary forms,           **
+**    with or without modification please see LICENSE.                 **
+**                                                                     **
+\*                                                                     */
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace lrt {
+namespace simd {
+
+/**
+ * @brief Native vector types for 4 and 8 lanes
+ *
+ * Based on the GCC/Clang vector extensions, so the same code maps to SSE/AVX on x86 and NEON on ARM.
+ * The 8 lane type is only aligned to 16 bytes, so it could live in plain heap memory. On targets
+ * without AVX the compiler splits it up into two 4 lane operations.
+ */
+template<int N>
+struct SIMDTraits;
+
+template<>
+struct SIMDTraits<4> {
+    typedef float type __attribute__((vector_size(16)));
+    typedef int32_t mask __attribute__((vector_size(16)));
+    typedef uint32_t umask __attribute__((vector_size(16)));
+};
+
+template<>
+struct SIMDTraits<8> {
+    typedef float type __attribute__((vector_size(32), aligned(16)));
+    typedef int32_t mask __attribute__((vector_size(32), aligned(16)));
+    typedef uint32_t umask __attribute__((vector_size(32), aligned(16)));
+};
+
+
+/**
+ * @brief Packed float vector with N lanes
+ */
+template<int N>
+struct floatv {
+    static const int SIZE = N;
+
+    typedef typename SIMDTraits<N>::type type;
+    typedef typename SIMDTraits<N>::mask mask;
+
+    type v;
+
+
+    floatv() {}
+
+
+    floatv(type v) : v(v) {}
+
+
+    /**
+     * @brief Broadcast a scalar to all lanes
+     * @param x
+     */
+    floatv(float x) {
+        type zero = {};
+        v = zero + x;
+    }
+
+
+    /**
+     * @brief Load N floats from memory, no alignment required
+     * @param p
+     * @return
+     */
+    static floatv load(const float *p) {
+        floatv r;
+        memcpy(&r.v, p, sizeof(type));
+        return r;
+    }
+
+
+    /**
+     * @brief Store N floats to memory, no alignment required
+     * @param p
+     */
+    void store(float *p) const {
+        memcpy(p, &v, sizeof(type));
+    }
+
+
+    /**
+     * @brief Set all lanes to zero
+     * @return
+     */
+    static floatv zero() {
+        return floatv(0.f);
+    }
+
+
+    float operator[](int i) const {
+        return v[i];
+    }
+
+
+    void set(int i, float x) {
+        v[i] = x;
+    }
+
+
+    /**
+     * @brief Reinterpret the bits as integer mask
+     * @return
+     */
+    mask bits() const {
+        return (mask) v;
+    }
+
+
+    static floatv fromBits(mask m) {
+        return floatv((type) m);
+    }
+};
+
+typedef floatv<4> float4;
+typedef floatv<8> float8;
+
+
+/* arithmetic */
+
+template<int N>
+inline floatv<N> operator+(floatv<N> a, floatv<N> b) { return a.v + b.v; }
+
+template<int N>
+inline floatv<N> operator-(floatv<N> a, floatv<N> b) { return a.v - b.v; }
+
+template<int N>
+inline floatv<N> operator*(floatv<N> a, floatv<N> b) { return a.v * b.v; }
+
+template<int N>
+inline floatv<N> operator/(floatv<N> a, floatv<N> b) { return a.v / b.v; }
+
+template<int N>
+inline floatv<N> operator-(floatv<N> a) { return -a.v; }
+
+template<int N>
+inline floatv<N> operator+(floatv<N> a, float b) { return a + floatv<N>(b); }
+
+template<int N>
+inline floatv<N> operator-(floatv<N> a, float b) { return a - floatv<N>(b); }
+
+template<int N>
+inline floatv<N> operator*(floatv<N> a, float b) { return a * floatv<N>(b); }
+
+template<int N>
+inline floatv<N> operator/(floatv<N> a, float b) { return a / floatv<N>(b); }
+
+template<int N>
+inline floatv<N> operator+(float a, floatv<N> b) { return floatv<N>(a) + b; }
+
+template<int N>
+inline floatv<N> operator-(float a, floatv<N> b) { return floatv<N>(a) - b; }
+
+template<int N>
+inline floatv<N> operator*(float a, floatv<N> b) { return floatv<N>(a) * b; }
+
+template<int N>
+inline floatv<N> operator/(float a, floatv<N> b) { return floatv<N>(a) / b; }
+
+template<int N>
+inline floatv<N> &operator+=(floatv<N> &a, floatv<N> b) { return a = a + b; }
+
+template<int N>
+inline floatv<N> &operator-=(floatv<N> &a, floatv<N> b) { return a = a - b; }
+
+template<int N>
+inline floatv<N> &operator*=(floatv<N> &a, floatv<N> b) { return a = a * b; }
+
+template<int N>
+inline floatv<N> &operator/=(floatv<N> &a, floatv<N> b) { return a = a / b; }
+
+
+/* comparisons, return a bit mask with all bits set for true lanes */
+
+template<int N>
+inline floatv<N> operator<(floatv<N> a, floatv<N> b) { return floatv<N>::fromBits(a.v < b.v); }
+
+template<int N>
+inline floatv<N> operator<=(floatv<N> a, floatv<N> b) { return floatv<N>::fromBits(a.v <= b.v); }
+
+template<int N>
+inline floatv<N> operator>(floatv<N> a, floatv<N> b) { return floatv<N>::fromBits(a.v > b.v); }
+
+template<int N>
+inline floatv<N> operator>=(floatv<N> a, floatv<N> b) { return floatv<N>::fromBits(a.v >= b.v); }
+
+template<int N>
+inline floatv<N> operator<(floatv<N> a, float b) { return a < floatv<N>(b); }
+
+template<int N>
+inline floatv<N> operator<=(floatv<N> a, float b) { return a <= floatv<N>(b); }
+
+template<int N>
+inline floatv<N> operator>(floatv<N> a, float b) { return a > floatv<N>(b); }
+
+template<int N>
+inline floatv<N> operator>=(floatv<N> a, float b) { return a >= floatv<N>(b); }
+
+
+/* bitwise */
+
+template<int N>
+inline floatv<N> operator&(floatv<N> a, floatv<N> b) { return floatv<N>::fromBits(a.bits() & b.bits()); }
+
+template<int N>
+inline floatv<N> operator|(floatv<N> a, floatv<N> b) { return floatv<N>::fromBits(a.bits() | b.bits()); }
+
+template<int N>
+inline floatv<N> operator^(floatv<N> a, floatv<N> b) { return floatv<N>::fromBits(a.bits() ^ b.bits()); }
+
+
+/**
+ * @brief Lane-wise select, picks a where the mask is set and b otherwise
+ * @param mask Result of a comparison
+ * @param a
+ * @param b
+ * @return
+ */
+template<int N>
+inline floatv<N> ifelse(floatv<N> mask, floatv<N> a, floatv<N> b) {
+    return floatv<N>::fromBits((mask.bits() & a.bits()) | (~mask.bits() & b.bits()));
+}
+
+
+template<int N>
+inline floatv<N> fmin(floatv<N> a, floatv<N> b) {
+    return ifelse(a < b, a, b);
+}
+
+
+template<int N>
+inline floatv<N> fmax(floatv<N> a, floatv<N> b) {
+    return ifelse(a > b, a, b);
+}
+
+
+template<int N>
+inline floatv<N> fabs(floatv<N> a) {
+    typename floatv<N>::mask zero = {};
+    return floatv<N>::fromBits(a.bits() & (zero + 0x7fffffff));
+}
+
+
+template<int N>
+inline floatv<N> clampf(floatv<N> x, floatv<N> min, floatv<N> max) {
+    return fmax(fmin(x, max), min);
+}
+
+
+/* approximations used by the polyphonic engines */
+
+/**
+ * @brief Lane-wise version of lrt::fastatan(), bit-identical to the scalar version
+ * @param x
+ * @return
+ */
+template<int N>
+inline floatv<N> fastatan(floatv<N> x) {
+    return x / (1.f + 0.28f * (x * x));
+}
+
+
+/**
+ * @brief Lane-wise atan over the full range, max. absolute error 1.2e-5
+ *
+ * Polynomial of Abramowitz & Stegun 4.4.49 on |x| <= 1, larger arguments are reflected by
+ * atan(x) = pi/2 - atan(1/x).
+ * @param x
+ * @return
+ */
+template<int N>
+inline floatv<N> atanf(floatv<N> x) {
+    floatv<N> ax = fabs(x);
+    floatv<N> big = ax > 1.f;
+    floatv<N> z = ifelse(big, 1.f / ax, ax);
+    floatv<N> z2 = z * z;
+
+    floatv<N> p = z * (0.9998660f + z2 * (-0.3302995f + z2 * (0.1801410f + z2 * (-0.0851330f + z2 * 0.0208351f))));
+    p = ifelse(big, 1.57079632f - p, p);
+
+    /* restore the sign of x */
+    typename floatv<N>::mask zero = {};
+    return floatv<N>::fromBits(p.bits() | (x.bits() & (zero + (int32_t) 0x80000000)));
+}
+
+
+/**
+ * @brief Lane-wise tanh, Pade approximant clamped where it reaches 1, max. absolute error 1e-4
+ * @param x
+ * @return
+ */
+template<int N>
+inline floatv<N> fastTanh(floatv<N> x) {
+    x = clampf(x, floatv<N>(-4.97f), floatv<N>(4.97f));
+    floatv<N> x2 = x * x;
+
+    return x * (135135.f + x2 * (17325.f + x2 * (378.f + x2))) / (135135.f + x2 * (62370.f + x2 * (3150.f + x2 * 28.f)));
+}
+
+
+/**
+ * @brief Lane-wise floor, arguments beyond +/-2^23 are integral already and pass through
+ * @param x
+ * @return
+ */
+template<int N>
+inline floatv<N> floor(floatv<N> x) {
+    typedef typename floatv<N>::type type;
+    typedef typename floatv<N>::mask mask;
+
+    /* truncate towards zero, step down where that rounded up */
+    floatv<N> t = __builtin_convertvector(__builtin_convertvector(x.v, mask), type);
+    t = t - (floatv<N>(1.f) & (t > x));
+
+    return ifelse(fabs(x) < 8388608.f, t, x);
+}
+
+
+/**
+ * @brief Lane-wise version of lrt::fastSin(), same polynomial, valid on -PI..PI
+ *
+ * Bit-identical to the scalar version, max. absolute error 1.9e-4 at +/-PI.
+ * @param angle
+ * @return
+ */
+template<int N>
+inline floatv<N> fastSin(floatv<N> angle) {
+    floatv<N> sqr = angle * angle;
+
+    return angle * (1.0f + sqr * (-1.666666664e-01f + sqr * (8.3333315e-03f + sqr * (-1.98409e-04f + sqr * (2.7526e-06f + sqr * -2.39e-08f)))));
+}
+
+
+/**
+ * @brief Lane-wise version of lrt::wrapTWOPI(), wraps to -PI..PI
+ *
+ * Ties are rounded up instead of away from zero, which only swaps -PI and PI.
+ * @param n
+ * @return
+ */
+template<int N>
+inline floatv<N> wrapTWOPI(floatv<N> n) {
+    const float twoPi = (float) M_PI * 2.f;
+
+    floatv<N> b = n * (1.f / twoPi);
+    return (b - floor(b + 0.5f)) * twoPi;
+}
+
+
+/**
+ * @brief Lane-wise version of lrt::fastExp2(), max. relative error 3e-7
+ * @param x Exponent, clamped to -126..127
+ * @return
+ */
+template<int N>
+inline floatv<N> fastExp2(floatv<N> x) {
+    typedef typename floatv<N>::mask mask;
+
+    x = clampf(x, floatv<N>(-126.f), floatv<N>(127.f));
+
+    floatv<N> e = floor(x);
+    floatv<N> f = x - e;
+
+    floatv<N> p = 1.f + f * (0.693147568f + f * (0.240207194f + f * (0.0556570544f + f * (0.0091993876f + f * 0.00178836874f))));
+
+    /* 2^e straight into the exponent bits */
+    mask bits = (__builtin_convertvector(e.v, mask) + 127) << 23;
+
+    return p * floatv<N>::fromBits(bits);
+}
+
+
+/**
+ * @brief Lane-wise version of lrt::fastlog2(), same quadratic, bit-identical to the scalar version
+ *
+ * Max. absolute error 9e-3 for all positive normal numbers. Zero, negative and denormal
+ * arguments return garbage like the scalar version.
+ * @param x
+ * @return
+ */
+template<int N>
+inline floatv<N> fastlog2(floatv<N> x) {
+    typedef typename floatv<N>::type type;
+    typedef typename floatv<N>::mask mask;
+
+    mask bits = x.bits();
+    mask exp = (bits >> 23) & 0xff;
+
+    /* significands >= 1.5 are halved by exponent 126 instead of 127, all bits set where true */
+    mask greater = (bits & 0x00400000) != 0;
+
+    floatv<N> signif = floatv<N>::fromBits((bits & 0x007fffff) | (0x3f800000 - (greater & 0x00800000))) - 1.f;
+    floatv<N> fexp = __builtin_convertvector(exp - 127 - greater, type);
+
+    return fexp + -.6296735f * signif * signif + 1.466967f * signif;
+}
+
+
+/**
+ * @brief Lane-wise version of lrt::fastlog()
+ * @param x
+ * @return
+ */
+template<int N>
+inline floatv<N> fastlog(floatv<N> x) {
+    return 0.6931472f * fastlog2(x);
+}
+
+
+/**
+ * @brief Lane-wise version of lrt::fastPow(), same bit trick on the upper word of a double
+ *
+ * Bit-identical to the scalar version for a > 0 as long as the result is a normal float, results
+ * beyond that saturate to FLT_MIN..FLT_MAX instead of 0 and infinity. The relative error grows with
+ * the exponent, up to 6% for |b| <= 1 and 18% for |b| <= 4.
+ * @param a Base, > 0
+ * @param b Exponent
+ * @return
+ */
+template<int N>
+inline floatv<N> fastPow(floatv<N> a, floatv<N> b) {
+    typedef typename floatv<N>::type type;
+    typedef typename floatv<N>::mask mask;
+
+    /* upper word of a as double: 11 bit exponent, 20 bit mantissa */
+    mask hi = (a.bits() >> 3) + ((1023 - 127) << 20);
+
+    floatv<N> t = b * floatv<N>(__builtin_convertvector(hi - 1072632447, type)) + 1072632447.f;
+
+    /* keep the exponent in the normal float range, the largest value is the last float below 2^31 */
+    t = clampf(t, floatv<N>(940572672.f), floatv<N>(1206910848.f));
+    hi = __builtin_convertvector(t.v, mask);
+
+    /* and back to float, the mantissa bits below the upper word are zero anyway */
+    return floatv<N>::fromBits((hi - ((1023 - 127) << 20)) << 3);
+}
+
+
+/**
+ * @brief Lane-wise version of lrt::pow2bpol(), quadratic bipolar
+ * @param x
+ * @return
+ */
+template<int N>
+inline floatv<N> pow2bpol(floatv<N> x) {
+    return x * fabs(x);
+}
+
+
+/**
+ * @brief Lane-wise version of lrt::cubicShape()
+ * @param x
+ * @return
+ */
+template<int N>
+inline floatv<N> cubicShape(floatv<N> x) {
+    return (x - 1.f) * (x - 1.f) * (x - 1.f) + 1.f;
+}
+
+
+/**
+ * @brief Lane-wise version of lrt::atanShaper()
+ * @param x
+ * @return
+ */
+template<int N>
+inline floatv<N> atanShaper(floatv<N> x) {
+    return x / (1.f + (0.28f * x * x));
+}
+
+
+/**
+ * @brief Lane-wise version of lrt::clip(), soft clipping
+ * @param x
+ * @param sat
+ * @param satinv
+ * @return
+ */
+template<int N>
+inline floatv<N> clip(floatv<N> x, float sat, float satinv) {
+    floatv<N> v2 = clampf(x * satinv, floatv<N>(-1.f), floatv<N>(1.f));
+    return sat * (v2 - (1.f / 3.f) * v2 * v2 * v2);
+}
+
+
+/**
+ * @brief Lane-wise single precision version of lrt::erf(), max. absolute error 8e-7
+ *
+ * Same formula (A&S 7.1.26, 1.5e-7), the exponential is taken by fastExp2().
+ * @param x
+ * @return
+ */
+template<int N>
+inline floatv<N> erf(floatv<N> x) {
+    floatv<N> xa = fabs(x);
+    floatv<N> t = 1.f / (1.f + 0.3275911f * xa);
+
+    floatv<N> y = 1.f - ((((1.061405429f * t - 1.453152027f) * t + 1.421413741f) * t - 0.284496736f) * t + 0.254829592f) * t *
+                        fastExp2(xa * xa * -1.44269504f);
+
+    /* restore the sign of x */
+    typename floatv<N>::mask zero = {};
+    return floatv<N>::fromBits(y.bits() | (x.bits() & (zero + (int32_t) 0x80000000)));
+}
+
+
+/**
+ * @brief True if the mask (result of a comparison) is set in any lane
+ * @param mask
+ * @return
+ */
+template<int N>
+inline bool any(floatv<N> mask) {
+    typename floatv<N>::mask m = mask.bits();
+
+    for (int i = 0; i < N; i++) {
+        if (m[i]) return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief Lane-wise version of lrt::polyBLEP()
+ * @param t Normalized phase 0..1
+ * @param dt Phase increment per sample
+ * @return
+ */
+template<int N>
+inline floatv<N> polyBLEP(floatv<N> t, floatv<N> dt) {
+    floatv<N> a = t / dt;
+    floatv<N> b = (t - 1.f) / dt;
+
+    a = a + a - a * a - 1.f;
+    b = b * b + b + b + 1.f;
+
+    return ifelse(t < dt, a, ifelse(t > 1.f - dt, b, floatv<N>(0.f)));
+}
+
+
+/**
+ * @brief Lane-wise version of lrt::polyBLAMP()
+ * @param t Normalized phase 0..1
+ * @param dt Phase increment per sample
+ * @return
+ */
+template<int N>
+inline floatv<N> polyBLAMP(floatv<N> t, floatv<N> dt) {
+    floatv<N> a = t / dt - 1.f;
+    floatv<N> b = (t - 1.f) / dt + 1.f;
+
+    a = a * a * a * (-1.f / 3.f);
+    b = b * b * b * (1.f / 3.f);
+
+    return ifelse(t < dt, a, ifelse(t > 1.f - dt, b, floatv<N>(0.f)));
+}
+
+
+/**
+ * @brief Uniform noise in 0..gain like lrt::Noise, with an independent generator (LCG) per lane
+ */
+template<int N>
+struct NoiseV {
+    typedef typename SIMDTraits<N>::umask state;
+
+    state s;
+
+
+    /**
+     * @brief Seed the lanes with consecutive values, banks of several vectors pass distinct seeds
+     * @param seed
+     */
+    explicit NoiseV(uint32_t seed = 22222u) {
+        for (int i = 0; i < N; i++) {
+            s[i] = seed + 7919u * i;
+        }
+    }
+
+
+    inline floatv<N> getNext(float gain) {
+        s = s * 1664525u + 1013904223u;
+
+        /* upper 23 bits as mantissa give 1..2 */
+        state bits = (s >> 9) | 0x3f800000u;
+
+        return (floatv<N>((typename floatv<N>::type) bits) - 1.f) * gain;
+    }
+};
+
+
+
+/**
+ * @brief Lane-wise version of lrt::ControlRamp in exponential mode
+ *
+ * Each lane moves geometrically towards its target, lanes where one of both ends is zero or the
+ * sign changes fall back to a linear ramp. The step is computed once per set(), next() is one
+ * multiply-add for all lanes.
+ */
+template<int N>
+struct ControlRampV {
+    floatv<N> value = 0.f, target = 0.f;
+    floatv<N> mul = 1.f, add = 0.f;
+    int remaining = 0;
+
+
+    /**
+     * @brief Start a new ramp from the current value
+     * @param target
+     * @param samples Length of the ramp, the target is applied at once for 1 or less
+     */
+    void set(floatv<N> target, int samples) {
+        ControlRampV::target = target;
+
+        if (samples <= 1) {
+            value = target;
+            remaining = 0;
+            return;
+        }
+
+        for (int i = 0; i < N; i++) {
+            if (value[i] * target[i] > 0.f) {
+                mul.set(i, powf(target[i] / value[i], 1.f / samples));
+                add.set(i, 0.f);
+            } else {
+                mul.set(i, 1.f);
+                add.set(i, (target[i] - value[i]) / samples);
+            }
+        }
+
+        remaining = samples;
+    }
+
+
+    /**
+     * @brief Set value and target of all lanes without ramping
+     * @param value
+     */
+    void jump(floatv<N> value) {
+        ControlRampV::value = value;
+        target = value;
+        remaining = 0;
+    }
+
+
+    inline bool isRamping() const {
+        return remaining > 0;
+    }
+
+
+    inline floatv<N> next() {
+        if (remaining > 0) {
+            value = --remaining == 0 ? target : value * mul + add;
+        }
+
+        return value;
+    }
+};
+
+}
+
+using simd::float4;
+using simd::float8;
+
+}
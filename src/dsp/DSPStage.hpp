@@ -0,0 +1,84 @@
+/*                                                                     *\
+**       __   ___  ______                                              **
+**      / /  / _ \/_  __/                                              **
+**     / /__/ , _/ / /    Lindenberg                                   **
+**    /____/_/|_| /_/  Research Tec.                                   **
+**                                                                     **
+**                                                                     **
+**	  https://github.com/lindenbergresearch/LRTRack	                   **
+**    heapdump@icloud.com                                              **
+**		                                                               **
+**    Sound Modules for VCV Rack                                       **
+**    Copyright 2017-2019 by Patrick Lindenberg / LRT                  **
+**                                                                     **
+**    For Redistribution and use in source and binary forms,           **
+**    with or without modification please see LICENSE.                 **
+**                                                                     **
+\*                                                                     */
+#pragma once
+
+namespace lrt {
+
+/**
+ * @brief Base class for the stages of a nested processor, dispatched at compile time (CRTP)
+ *
+ * A stage implements `tick(x)` and `reset()` and is embedded by value into its owner. There is no
+ * virtual call and no pointer to follow, so the stages of an engine end up inlined into one loop
+ * body. Module code keeps using the runtime interface of DSPEffect / DSPSystem.
+ *
+ * @tparam S Derived stage type
+ */
+template<typename S>
+struct DSPStage {
+
+    /**
+     * @brief Compute the next sample of the stage
+     * @param x Input sample
+     * @return
+     */
+    template<typename T>
+    inline T process(T x) {
+        return static_cast<S *>(this)->tick(x);
+    }
+
+
+    /**
+     * @brief Run a block through the stage in place
+     * @param x Samples
+     * @param n Number of samples
+     */
+    template<typename T>
+    inline void processBlock(T *x, int n) {
+        for (int i = 0; i < n; i++) {
+            x[i] = static_cast<S *>(this)->tick(x[i]);
+        }
+    }
+};
+
+
+/**
+ * @brief N identical stages in series, the loop has a constant trip count and gets unrolled
+ */
+template<typename S, int N>
+struct StageRepeat : DSPStage<StageRepeat<S, N>> {
+    S stage[N];
+
+
+    template<typename T>
+    inline T tick(T x) {
+        for (int i = 0; i < N; i++) {
+            x = stage[i].tick(x);
+        }
+
+        return x;
+    }
+
+
+    inline void reset() {
+        for (int i = 0; i < N; i++) {
+            stage[i].reset();
+        }
+    }
+};
+
+}
@@ -55,6 +55,12 @@ protected:
 
     float sr;
 
+    /* set on parameter changes, the next update() recomputes the coefficients */
+    bool dirty = true;
+
+    /* length of the coefficient ramps started by invalidate(), 1 means immediate (audio rate) */
+    int rampLength = 1;
+
 public:
 
     /**
@@ -72,6 +78,9 @@ public:
     explicit DSPSystem(float sr) : sr(sr) {}
 
 
+    virtual ~DSPSystem() {}
+
+
     virtual /**
          * @brief Update sample rate on change
          * @param sr
@@ -86,7 +95,7 @@ public:
      * @brief Update a parameter of the system
      * @param id Parameter ID
      * @param value Value
-     * @param trigger Trigger call of invalidate() - use false to supress
+     * @param trigger Mark the system dirty, invalidate() is deferred to the next update() - use false to supress
      */
     void setParam(int id, float value, bool trigger = true) {
         if (param[id].value != value) {
@@ -94,13 +103,34 @@ public:
 
             /* setup of new parameter triggers invalidation per default */
             if (trigger) {
-                invalidate();
+                dirty = true;
             }
         }
 
     }
 
 
+    /**
+     * @brief Run invalidate() once if any parameter changed since the last call. Called by process(),
+     * so several changed parameters cost a single recalculation per sample (or per block).
+     */
+    void update() {
+        if (dirty) {
+            dirty = false;
+            invalidate();
+        }
+    }
+
+
+    /**
+     * @brief Set the length of the coefficient ramps, usually the control rate of the calling module
+     * @param samples Number of samples, 1 switches to audio rate
+     */
+    void setRampLength(int samples) {
+        rampLength = samples < 1 ? 1 : samples;
+    }
+
+
     /**
      * @brief Get the current parameter value by ID
      * @param id Parameter ID
@@ -143,9 +173,22 @@ public:
 
     /**
      * @brief Process one step and return the computed sample
+     *
+     * Engines with an audio input add `void processBlock(const float *in, float *out, int frames)`,
+     * which shares the state with process(). There is no default, an engine without a block path
+     * does not compile instead of returning nothing.
      * @return
      */
     virtual void process() {};
+
+
+    /**
+     * @brief Processing latency in samples at the host rate, e.g. caused by oversampling
+     * @return
+     */
+    virtual double getLatency() {
+        return 0.;
+    }
 };
 
 
@@ -3,52 +3,13 @@
 using namespace lrt;
 
 
-DiodeLadderStage::DiodeLadderStage(float sr) : DSPEffect(sr) {
-
-}
-
-
-void DiodeLadderStage::init() {
-    alpha = 1.f;
-    beta = -1.f;
-    gamma = 1.f;
-    delta = 0.f;
-    epsilon = 1.f;
-    feedback = 0.f;
-    gain = 1.f;
-
-
-    resetZ1();
-}
-
-
-void DiodeLadderStage::invalidate() {
-    DSPEffect::invalidate();
-}
-
-
-void DiodeLadderStage::process() {
-    float x = (in * gamma + feedback + epsilon * getFeedbackOutput());
-    float vn = (gain * x - z1) * alpha;
-
-    out = vn + z1;
-
-    z1 = vn + out;
-}
-
-
-float DiodeLadderStage::getFeedbackOutput() {
-    return (z1 + feedback * delta) * beta;
-}
-
-
 DiodeLadderFilter::DiodeLadderFilter(float sr) : DSPEffect(sr) {
-    lpf1 = new DiodeLadderStage(sr);
-    lpf2 = new DiodeLadderStage(sr);
-    lpf3 = new DiodeLadderStage(sr);
-    lpf4 = new DiodeLadderStage(sr);
+    linear = new Resampler<1>(OVERSAMPLE, 4);
+    minimum = new Resampler<1>(OVERSAMPLE, 4, Resampler<1>::MINPHASE);
+    rs = linear;
 
-    rs = new Resampler<1>(OVERSAMPLE, 4);
+    table = CutoffTable::get(1000.f, 0.f, sr);
+    tableOversampled = CutoffTable::get(1000.f, 0.f, sr * OVERSAMPLE);
 
     gamma = 0.f;
     k = 0.f;
@@ -59,15 +20,15 @@ DiodeLadderFilter::DiodeLadderFilter(float sr) : DSPEffect(sr) {
     sg3 = 0.f;
     sg4 = 0.f;
 
-    lpf1->gain = 1.f;
-    lpf2->gain = 0.5f;
-    lpf3->gain = 0.5f;
-    lpf4->gain = 0.5f;
+    lpf1.gain = 1.f;
+    lpf2.gain = 0.5f;
+    lpf3.gain = 0.5f;
+    lpf4.gain = 0.5f;
 
-    lpf4->gamma = 1.f;
-    lpf4->delta = 0.f;
-    lpf4->epsilon = 0.f;
-    lpf4->setFeedback(0.f);
+    lpf4.gamma = 1.f;
+    lpf4.delta = 0.f;
+    lpf4.epsilon = 0.f;
+    lpf4.setFeedback(0.f);
 }
 
 
@@ -79,17 +40,22 @@ void DiodeLadderFilter::init() {
 
 
 void DiodeLadderFilter::invalidate() {
-    float G1, G2, G3, G4;
+    const CutoffTable *t = low ? table : tableOversampled;
 
-    float SR = low ? sr : sr * OVERSAMPLE;
+    /* 20Hz * 1000^fc, prewarped at the rate the ladder runs at */
+    freqHz = t->getHz(fc);
 
-    freqHz = MAX_FREQUENCY / 1000.f * powf(1000.f, fc);
-    // freqHz = 40.f * powf(500.f, fc);
+    gRamp.set(t->getG(fc), rampLength);
+    setCoefficients(gRamp.value);
+}
 
-    float wd = TWOPI * freqHz;
-    float T = 1 / SR;
-    float wa = (2 / T) * tanf(wd * T / 2);
-    float g = wa * T / 2;
+
+/**
+ * @brief Derive all stage coefficients from the warped cutoff, cheap enough to run on every ramp step
+ * @param g Warped cutoff
+ */
+void DiodeLadderFilter::setCoefficients(float g) {
+    float G1, G2, G3, G4;
 
     G4 = 0.5f * g / (1.0f + g);
     G3 = 0.5f * g / (1.0f + g - 0.5f * g * G4);
@@ -103,31 +69,34 @@ void DiodeLadderFilter::invalidate() {
     sg3 = G4;
     sg4 = 1.0f;
 
-    lpf1->alpha = g / (1.0f + g);
-    lpf2->alpha = g / (1.0f + g);
-    lpf3->alpha = g / (1.0f + g);
-    lpf4->alpha = g / (1.0f + g);
+    lpf1.alpha = g / (1.0f + g);
+    lpf2.alpha = g / (1.0f + g);
+    lpf3.alpha = g / (1.0f + g);
+    lpf4.alpha = g / (1.0f + g);
 
-    lpf1->beta = 1.0f / (1.0f + g - g * G2);
-    lpf2->beta = 1.0f / (1.0f + g - 0.5f * g * G3);
-    lpf3->beta = 1.0f / (1.0f + g - 0.5f * g * G4);
-    lpf4->beta = 1.0f / (1.0f + g);
+    lpf1.beta = 1.0f / (1.0f + g - g * G2);
+    lpf2.beta = 1.0f / (1.0f + g - 0.5f * g * G3);
+    lpf3.beta = 1.0f / (1.0f + g - 0.5f * g * G4);
+    lpf4.beta = 1.0f / (1.0f + g);
 
-    lpf1->gamma = 1.0f + G1 * G2;
-    lpf2->gamma = 1.0f + G2 * G3;
-    lpf3->gamma = 1.0f + G3 * G4;
+    lpf1.gamma = 1.0f + G1 * G2;
+    lpf2.gamma = 1.0f + G2 * G3;
+    lpf3.gamma = 1.0f + G3 * G4;
 
-    lpf1->delta = g;
-    lpf2->delta = 0.5f * g;
-    lpf3->delta = 0.5f * g;
+    lpf1.delta = g;
+    lpf2.delta = 0.5f * g;
+    lpf3.delta = 0.5f * g;
 
-    lpf1->epsilon = G2;
-    lpf2->epsilon = G3;
-    lpf3->epsilon = G4;
+    lpf1.epsilon = G2;
+    lpf2.epsilon = G3;
+    lpf3.epsilon = G4;
 }
 
 
 void DiodeLadderFilter::process() {
+    update();
+    updateRamp();
+
     if (low) {
         process1();
     } else {
@@ -137,14 +106,14 @@ void DiodeLadderFilter::process() {
 
 
 void DiodeLadderFilter::process1() {
-    lpf3->setFeedback(lpf4->getFeedbackOutput());
-    lpf2->setFeedback(lpf3->getFeedbackOutput());
-    lpf1->setFeedback(lpf2->getFeedbackOutput());
+    lpf3.setFeedback(lpf4.getFeedbackOutput());
+    lpf2.setFeedback(lpf3.getFeedbackOutput());
+    lpf1.setFeedback(lpf2.getFeedbackOutput());
 
-    float sigma = sg1 * lpf1->getFeedbackOutput() +
-                  sg2 * lpf2->getFeedbackOutput() +
-                  sg3 * lpf3->getFeedbackOutput() +
-                  sg4 * lpf4->getFeedbackOutput();
+    float sigma = sg1 * lpf1.getFeedbackOutput() +
+                  sg2 * lpf2.getFeedbackOutput() +
+                  sg3 * lpf3.getFeedbackOutput() +
+                  sg4 * lpf4.getFeedbackOutput();
 
     float y = (1.0f / fastatan(saturation)) * fastatan(saturation * in);
 
@@ -154,20 +123,13 @@ void DiodeLadderFilter::process1() {
 
     u = fastatan(u / FEEDBACK_LIMITER_GAIN) * FEEDBACK_LIMITER_GAIN; // limit feedback gain of resonance
 
-    lpf1->in = u;
-    lpf1->process();
-
-    lpf2->in = lpf1->out;
-    lpf2->process();
-
-    lpf3->in = lpf2->out;
-    lpf3->process();
+    y = lpf1.tick(u);
+    y = lpf2.tick(y);
+    y = lpf3.tick(y);
+    y = lpf4.tick(y);
 
-    lpf4->in = lpf3->out;
-    lpf4->process();
-
-    out2 = tanh(u - lpf4->out);
-    out = tanh(lpf4->out);
+    out2 = tanh(u - y);
+    out = tanh(y);
 }
 
 
@@ -185,19 +147,91 @@ void DiodeLadderFilter::process2() {
 }
 
 
+void DiodeLadderFilter::setLowLatency(bool lowLatency) {
+    Resampler<1> *next = lowLatency ? minimum : linear;
+    if (next == rs) return;
+
+    /* start with clean histories, the other resampler is stale */
+    next->reset();
+    rs = next;
+}
+
+
+void DiodeLadderFilter::processBlock(const float *in, float *out, int frames) {
+    processBlock(in, out, nullptr, frames);
+}
+
+
+void DiodeLadderFilter::processBlock(const float *in, float *lp, float *hp, int frames) {
+    update();
+
+    if (low) {
+        for (int i = 0; i < frames; i++) {
+            updateRamp();
+
+            DiodeLadderFilter::in = in[i];
+            process1();
+
+            lp[i] = out;
+            if (hp != nullptr) hp[i] = out2;
+        }
+
+        return;
+    }
+
+    float *os = rs->getBlockBuffer();
+    int factor = rs->getFactor();
+
+    while (frames > 0) {
+        int n = frames < RS_BLOCK_SIZE ? frames : RS_BLOCK_SIZE;
+
+        rs->upsampleBlock(IN, in, n, os);
+
+        for (int i = 0; i < n; i++) {
+            updateRamp();
+
+            for (int j = 0; j < factor; j++) {
+                DiodeLadderFilter::in = os[i * factor + j];
+                process1();
+                os[i * factor + j] = out;
+            }
+
+            /* the highpass output is taken from the last oversampled step, same as process() */
+            if (hp != nullptr) hp[i] = out2;
+        }
+
+        rs->decimateBlock(IN, os, n, lp);
+        out = lp[n - 1];
+
+        in += n;
+        lp += n;
+        if (hp != nullptr) hp += n;
+        frames -= n;
+    }
+}
+
+
 void DiodeLadderFilter::setSamplerate(float sr) {
-    DSPEffect::setSamplerate(sr);
+    table = CutoffTable::get(1000.f, 0.f, sr);
+    tableOversampled = CutoffTable::get(1000.f, 0.f, sr * OVERSAMPLE);
 
-    /* set samplerate for all submodules */
-    lpf1->setSamplerate(sr);
-    lpf2->setSamplerate(sr);
-    lpf3->setSamplerate(sr);
-    lpf4->setSamplerate(sr);
+    DSPEffect::setSamplerate(sr);
 }
 
 
 void DiodeLadderFilter::setFrequency(float fc) {
-    DiodeLadderFilter::fc = fc;
+    if (DiodeLadderFilter::fc != fc) {
+        DiodeLadderFilter::fc = fc;
+        markDirty();
+    }
+}
+
+
+void DiodeLadderFilter::setLow(bool low) {
+    if (DiodeLadderFilter::low != low) {
+        DiodeLadderFilter::low = low;
+        markDirty();
+    }
 }
 
 
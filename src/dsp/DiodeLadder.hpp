@@ -3,25 +3,41 @@
 #include "DSPEffect.hpp"
 #include "DSPMath.hpp"
 #include "HQTrig.hpp"
+#include "DSPStage.hpp"
+#include "CutoffTable.hpp"
 
 static const int OVERSAMPLE = 2;
 static const int FEEDBACK_LIMITER_GAIN = 25;
 namespace lrt {
 
-struct DiodeLadderStage : DSPEffect {
+/**
+ * @brief One pole of the ladder, embedded by value into DiodeLadderFilter and inlined
+ */
+struct DiodeLadderStage : DSPStage<DiodeLadderStage> {
+    float alpha = 1.f, beta = -1.f, gamma = 1.f, delta = 0.f, epsilon = 1.f;
+    float gain = 1.f;
+    float feedback = 0.f;
+    float z1 = 0.f;
 
-    float fc; // cutoff frq ????
-    float alpha, beta, gamma, delta, epsilon;
-    float gain;
-    float feedback;
-    float z1;
+    float out = 0.f;
 
-    float in, out;
 
-    explicit DiodeLadderStage(float sr);
-    void init() override;
-    void invalidate() override;
-    void process() override;
+    inline float tick(float in) {
+        float x = (in * gamma + feedback + epsilon * getFeedbackOutput());
+        float vn = (gain * x - z1) * alpha;
+
+        out = vn + z1;
+
+        z1 = vn + out;
+
+        return out;
+    }
+
+
+    inline void reset() {
+        resetZ1();
+        setFeedback(0.f);
+    }
 
 
     void resetZ1() {
@@ -39,7 +55,9 @@ struct DiodeLadderStage : DSPEffect {
     }
 
 
-    float getFeedbackOutput();
+    inline float getFeedbackOutput() {
+        return (z1 + feedback * delta) * beta;
+    }
 };
 
 
@@ -51,9 +69,16 @@ struct DiodeLadderFilter : DSPEffect {
 
     float fc, k, saturation, freqHz;
 
-    DiodeLadderStage *lpf1, *lpf2, *lpf3, *lpf4;
+    DiodeLadderStage lpf1, lpf2, lpf3, lpf4;
     Noise noise;
     Resampler<1> *rs;
+    Resampler<1> *linear, *minimum;
+
+    /* warped cutoff g, ramped per sample between control rate updates */
+    ControlRamp gRamp{ControlRamp::EXPONENTIAL};
+
+    /* shared cutoff tables for the host and the oversampled rate */
+    const CutoffTable *table, *tableOversampled;
 
     bool low = false;
 
@@ -64,16 +89,37 @@ struct DiodeLadderFilter : DSPEffect {
     explicit DiodeLadderFilter(float sr);
     void init() override;
     void invalidate() override;
+    void setCoefficients(float g);
     void process() override;
+    void processBlock(const float *in, float *out, int frames);
+
+
+    /**
+     * @brief Block version of process() with both outputs
+     * @param in Input samples
+     * @param lp Lowpass output, same as getOut()
+     * @param hp Highpass output, same as getOut2(), may be nullptr
+     * @param frames Number of samples
+     */
+    void processBlock(const float *in, float *lp, float *hp, int frames);
 
     void process1();
     void process2();
 
 
+    /**
+     * @brief Advance the cutoff ramp by one sample at the host rate
+     */
+    inline void updateRamp() {
+        if (gRamp.isRamping()) setCoefficients(gRamp.next());
+    }
+
+
     void setSamplerate(float sr) override;
 
 
     void setFrequency(float fc);
+    void setLow(bool low);
     void setResonance(float k);
     void setIn(float in);
     float getOut() const;
@@ -86,16 +132,34 @@ struct DiodeLadderFilter : DSPEffect {
     }
 
 
+    /**
+     * @brief Switch to the minimum phase resampler, which keeps the delay in feedback patches short
+     * @param lowLatency
+     */
+    void setLowLatency(bool lowLatency);
+
+
+    bool isLowLatency() const {
+        return rs == minimum;
+    }
+
+
+    /**
+     * @brief No latency if oversampling is turned off
+     * @return
+     */
+    double getLatency() override {
+        if (low) return 0.;
+
+        return rs->getLatency();
+    }
+
+
     void reset() {
-        lpf1->resetZ1();
-        lpf2->resetZ1();
-        lpf3->resetZ1();
-        lpf4->resetZ1();
-
-        lpf1->setFeedback(0.f);
-        lpf2->setFeedback(0.f);
-        lpf3->setFeedback(0.f);
-        lpf4->setFeedback(0.f);
+        lpf1.reset();
+        lpf2.reset();
+        lpf3.reset();
+        lpf4.reset();
     }
 };
 
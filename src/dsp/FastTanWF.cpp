@@ -5,6 +5,7 @@ using namespace lrt;
 
 FastTan::FastTan(float sr) : WaveShaper(sr) {
     init();
+    initAdaptive();
     noise = new Noise;
 }
 
@@ -34,7 +35,7 @@ double FastTan::compute(double x) {
     in = fastatan(in * 10) / 10;
 
     in *= 1 / FASTTAN_GAIN * (1 + gain / 15);
-    if (blockDC) in = dc->filter(in);
+    if (blockDC) in = dc[state]->filter(in);
 
     out = in;
 
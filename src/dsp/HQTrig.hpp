@@ -13,14 +13,84 @@ struct HQTanh : DSPEffect {
     static const int STD_CHANNEL = 0;
 
     int factor;
-    double in, out, xn1, fn1;
+    double in = 0., out = 0.;
+
+    /* antiderivative state, the direct path of the adaptive oversampling keeps its own */
+    double xn1 = 0., fn1 = 0.;
+    double xd1 = 0., fd1 = 0.;
+
     Resampler<1> *rs;
+    AdaptiveOversampling *adaptive = nullptr;
+    bool adaptiveActive = false;
 
 
     HQTanh(float sr, int factor, int quality = 4) : DSPEffect(sr) {
         HQTanh::factor = factor;
 
         rs = new Resampler<1>(factor, factor * quality);
+
+        /* allocated up front, setAdaptive() only switches */
+        if (factor > 1) adaptive = new AdaptiveOversampling(rs);
+    }
+
+
+    ~HQTanh() {
+        delete adaptive;
+        delete rs;
+    }
+
+
+    HQTanh(const HQTanh &) = delete;
+    HQTanh &operator=(const HQTanh &) = delete;
+
+
+    /**
+     * @brief Clear the antiderivative state and the resampler
+     */
+    void reset() {
+        in = out = 0.;
+        xn1 = fn1 = 0.;
+        xd1 = fd1 = 0.;
+
+        rs->reset();
+        if (adaptive != nullptr) adaptive->reset();
+    }
+
+
+    /**
+     * @brief Enable adaptive oversampling, the factor is then chosen per block from the input level
+     * and slope. Has no effect without oversampling. Only switches a flag, so it could be called
+     * from the audio thread.
+     * @param adaptive
+     */
+    void setAdaptive(bool adaptive) {
+        adaptive = adaptive && HQTanh::adaptive != nullptr;
+
+        if (adaptive == adaptiveActive) return;
+
+        adaptiveActive = adaptive;
+
+        if (adaptive) {
+            HQTanh::adaptive->reset();
+        } else {
+            rs->reset();
+        }
+    }
+
+
+    bool isAdaptive() const {
+        return adaptiveActive;
+    }
+
+
+    /**
+     * @brief Returns the oversampling factor currently in use, for metering
+     * @return
+     */
+    int getActiveFactor() {
+        if (adaptiveActive) return adaptive->getFactor();
+
+        return rs->getFactor();
     }
 
 
@@ -33,6 +103,15 @@ struct HQTanh : DSPEffect {
     }
 
 
+    /**
+     * @brief Resampler latency, the antiderivative antialiasing adds half a sample at the oversampled rate
+     * @return
+     */
+    double getLatency() override {
+        return rs->getLatency() + 0.5 / rs->getFactor();
+    }
+
+
     void init() override {
         DSPEffect::init();
     }
@@ -62,6 +141,18 @@ struct HQTanh : DSPEffect {
      * @return
      */
     inline double computeAA(double x) {
+        return computeAA(x, xn1, fn1);
+    }
+
+
+    /**
+     * @brief Generate an anti-aliased tanh with the given antiderivative state
+     * @param x
+     * @param xn1 Last input
+     * @param fn1 Antiderivative of the last input
+     * @return
+     */
+    static inline double computeAA(double x, double &xn1, double &fn1) {
         double fn = log(cosh(x));
         double xn, out;
 
@@ -83,6 +174,11 @@ struct HQTanh : DSPEffect {
      * @brief Compute tanh
      */
     inline void process() override {
+        if (adaptiveActive) {
+            processAdaptive();
+            return;
+        }
+
         rs->doUpsample(STD_CHANNEL, in);
 
         for (int i = 0; i < rs->getFactor(); i++) {
@@ -93,6 +189,90 @@ struct HQTanh : DSPEffect {
         out = rs->getDownsampled(STD_CHANNEL);
     }
 
+
+    inline double processOversampled(double x) {
+        rs->doUpsample(STD_CHANNEL, x);
+
+        for (int i = 0; i < rs->getFactor(); i++) {
+            double xo = rs->getUpsampled(STD_CHANNEL)[i];
+            rs->data[STD_CHANNEL][i] = computeAA(xo);
+        }
+
+        return rs->getDownsampled(STD_CHANNEL);
+    }
+
+
+    /**
+     * @brief Adaptive version of process(), tanh has its knee at 1, so the peak is the drive
+     */
+    inline void processAdaptive() {
+        double y = 0.;
+
+        adaptive->analyze(in);
+
+        if (adaptive->isDecisionPending() && adaptive->decide(adaptive->isAliasing(adaptive->peak))) {
+            for (int i = adaptive->warmup; i > 0; i--) {
+                processOversampled(adaptive->getHistory(i));
+            }
+        }
+
+        double xd = adaptive->delay(in);
+
+        if (adaptive->isOversampled()) {
+            y = adaptive->mix * processOversampled(in);
+        }
+
+        if (adaptive->isDirect()) {
+            /* the direct path has its own state, it starts from the last direct input again */
+            if (adaptive->isDirectStarting()) {
+                xd1 = adaptive->getDirectHistory(1) * UPSAMPLE_COMPENSATION;
+                fd1 = log(cosh(xd1));
+            }
+
+            y += (1. - adaptive->mix) * computeAA(xd * UPSAMPLE_COMPENSATION, xd1, fd1);
+        }
+
+        adaptive->next();
+
+        out = y;
+    }
+
+
+    /**
+     * @brief Block version of process()
+     * @param in Input samples
+     * @param out Output samples
+     * @param frames Number of samples
+     */
+    void processBlock(const float *in, float *out, int frames) {
+        if (adaptiveActive) {
+            for (int i = 0; i < frames; i++) {
+                out[i] = (float) next(in[i]);
+            }
+
+            return;
+        }
+
+        float *os = rs->getBlockBuffer();
+
+        while (frames > 0) {
+            int n = frames < RS_BLOCK_SIZE ? frames : RS_BLOCK_SIZE;
+
+            rs->upsampleBlock(STD_CHANNEL, in, n, os);
+
+            for (int i = 0; i < n * rs->getFactor(); i++) {
+                os[i] = (float) computeAA(os[i]);
+            }
+
+            rs->decimateBlock(STD_CHANNEL, os, n, out);
+            HQTanh::out = out[n - 1];
+
+            in += n;
+            out += n;
+            frames -= n;
+        }
+    }
+
 };
 
 
@@ -102,7 +282,7 @@ struct HQClip : DSPEffect {
     static const int STD_CHANNEL = 0;
 
     int factor;
-    double in, out, xn1, fn1;
+    double in = 0., out = 0., xn1 = 0., fn1 = 0.;
     Resampler<1> *rs;
 
 
@@ -113,6 +293,26 @@ struct HQClip : DSPEffect {
     }
 
 
+    ~HQClip() {
+        delete rs;
+    }
+
+
+    HQClip(const HQClip &) = delete;
+    HQClip &operator=(const HQClip &) = delete;
+
+
+    /**
+     * @brief Clear the antiderivative state and the resampler
+     */
+    void reset() {
+        in = out = 0.;
+        xn1 = fn1 = 0.;
+
+        rs->reset();
+    }
+
+
     /**
      * @brief Returns the actual sample-rate which is used by oversampled computation
      * @return
@@ -122,6 +322,15 @@ struct HQClip : DSPEffect {
     }
 
 
+    /**
+     * @brief Resampler latency, the antiderivative antialiasing adds half a sample at the oversampled rate
+     * @return
+     */
+    double getLatency() override {
+        return rs->getLatency() + 0.5 / rs->getFactor();
+    }
+
+
     void init() override {
         DSPEffect::init();
     }
@@ -184,6 +393,34 @@ struct HQClip : DSPEffect {
         out = rs->getDownsampled(STD_CHANNEL);
     }
 
+
+    /**
+     * @brief Block version of process()
+     * @param in Input samples
+     * @param out Output samples
+     * @param frames Number of samples
+     */
+    void processBlock(const float *in, float *out, int frames) {
+        float *os = rs->getBlockBuffer();
+
+        while (frames > 0) {
+            int n = frames < RS_BLOCK_SIZE ? frames : RS_BLOCK_SIZE;
+
+            rs->upsampleBlock(STD_CHANNEL, in, n, os);
+
+            for (int i = 0; i < n * rs->getFactor(); i++) {
+                os[i] = (float) computeAA(os[i]);
+            }
+
+            rs->decimateBlock(STD_CHANNEL, os, n, out);
+            HQClip::out = out[n - 1];
+
+            in += n;
+            out += n;
+            frames -= n;
+        }
+    }
+
 };
 
 
@@ -5,8 +5,17 @@ using namespace lrt;
 
 Hardclip::Hardclip(float sr) : WaveShaper(sr) {
     init();
+    initAdaptive();
     noise = new Noise;
-    hqclip = new HQClip(sr, 4);
+    hqclip[OVERSAMPLED_STATE] = new HQClip(sr, 4);
+    hqclip[DIRECT_STATE] = new HQClip(sr, 4);
+}
+
+
+Hardclip::~Hardclip() {
+    for (int i = 0; i < NUM_STATES; i++) {
+        delete hqclip[i];
+    }
 }
 
 
@@ -23,6 +32,12 @@ void Hardclip::process() {
 void Hardclip::invalidate() {}
 
 
+void Hardclip::resetState(int state) {
+    WaveShaper::resetState(state);
+    hqclip[state]->reset();
+}
+
+
 double Hardclip::compute(double x) {
     double out;
     double in = clampd(x, -SHAPER_MAX_VOLTS, SHAPER_MAX_VOLTS);
@@ -32,10 +47,10 @@ double Hardclip::compute(double x) {
 
     in *= HARDCLIP_GAIN;
 
-    in = hqclip->next(in);
+    in = hqclip[state]->next(in);
 
     in *= 1 / HARDCLIP_GAIN * 0.3;
-    if (blockDC) in = dc->filter(in);
+    if (blockDC) in = dc[state]->filter(in);
 
     out = in;
 
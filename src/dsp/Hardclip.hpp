@@ -9,18 +9,21 @@ namespace lrt {
 struct Hardclip : WaveShaper {
 
     Noise *noise;
-    HQClip *hqclip;
+    HQClip *hqclip[NUM_STATES];
 
 
 public:
 
     explicit Hardclip(float sr);
+    ~Hardclip();
 
     void init() override;
     void invalidate() override;
     void process() override;
     double compute(double x) override;
 
+protected:
+    void resetState(int state) override;
 };
 
 }
\ No newline at end of file
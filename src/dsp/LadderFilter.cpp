@@ -7,6 +7,21 @@ using namespace lrt;
  * @brief Check parameter
  */
 void LadderFilter::invalidate() {
+    // translate frequency to logarithmic scale
+    freqHz = 20.f * powf(1000.f, frequency);
+
+    freqRamp.set(clampf(freqHz * (1.f / (sr * OVERSAMPLE / 2.f)), 0.f, 0.9f), rampLength);
+    setCoefficients(freqRamp.value);
+}
+
+
+/**
+ * @brief Set coefficients given the normalized cutoff and the current resonance
+ * @param freqExp Normalized cutoff
+ */
+void LadderFilter::setCoefficients(float freqExp) {
+    LadderFilter::freqExp = freqExp;
+
     // Set coefficients given frequency & resonance [0.0...1.0]
     q = 1.0f - freqExp;
     p = freqExp + 0.8f * freqExp * q;
@@ -15,53 +30,110 @@ void LadderFilter::invalidate() {
 }
 
 
+/**
+ * @brief Compute one sample at the oversampled rate
+ * @param x Input sample
+ * @return
+ */
+inline float LadderFilter::tick(float x) {
+    // non linear feedback with nice saturation
+    x -= fastatan(bx * q);
+
+    t1 = b1;
+    b1 = ((x + b0) * p - b1 * f);
+
+    t2 = b2;
+    b2 = ((b1 + t1) * p - b2 * f);
+
+    t1 = b3;
+    b3 = ((b2 + t2) * p - b3 * f);
+
+    t2 = b4;
+    b4 = ((b3 + t1) * p - b4 * f);
+
+    b5 = ((b4 + t2) * p - b5 * f);
+
+    // fade over lpf poles from 3dB/oct (1P) => 48dB/oct (5P)
+    bx = fade5(b1, b2, b3, b4, b5, slope);
+
+    // saturate and add very low noise to have self oscillation with no input and high res
+    b0 = fastatan(x + noise.getNext(NOISE_GAIN));
+
+    float y = bx * (1 + drive * 40);
+
+    if (fabs(y) > 1) {
+        lightValue = (lightValue + fabs(y) / 5) / 2;
+    } else {
+        lightValue *= 0.99;
+    }
+
+
+    // overdrive with fast atan, which folds back the waves at high input and creates a noisy bright sound
+    return fastatan(y);
+}
+
+
 /**
  * @brief Calculate new sample
  * @return
  */
 void LadderFilter::process() {
+    update();
+    if (freqRamp.isRamping()) setCoefficients(freqRamp.next());
+
     rs->doUpsample(LOWPASS, in);
 
     for (int i = 0; i < rs->getFactor(); i++) {
-        float x = rs->getUpsampled(LOWPASS)[i];
+        rs->data[LOWPASS][i] = tick(rs->getUpsampled(LOWPASS)[i]);
+    }
 
-        // non linear feedback with nice saturation
-        x -= fastatan(bx * q);
+    lpOut = rs->getDownsampled(LOWPASS) * (INPUT_GAIN / (drive * 20 + 1) * (pow2bpol(drive * 3) + 1));
+}
 
-        t1 = b1;
-        b1 = ((x + b0) * p - b1 * f);
 
-        t2 = b2;
-        b2 = ((b1 + t1) * p - b2 * f);
+/**
+ * @brief Block version of process(), the input is scaled the same way as setIn() does
+ * @param in Input samples
+ * @param out Lowpass output samples
+ * @param frames Number of samples
+ */
+void LadderFilter::processBlock(const float *in, float *out, int frames) {
+    update();
 
-        t1 = b3;
-        b3 = ((b2 + t2) * p - b3 * f);
+    float *os = rs->getBlockBuffer();
+    int factor = rs->getFactor();
+    float gain = INPUT_GAIN / (drive * 20 + 1) * (pow2bpol(drive * 3) + 1);
 
-        t2 = b4;
-        b4 = ((b3 + t1) * p - b4 * f);
+    while (frames > 0) {
+        int n = frames < RS_BLOCK_SIZE ? frames : RS_BLOCK_SIZE;
 
-        b5 = ((b4 + t2) * p - b5 * f);
+        /* out is used as scratch for the scaled input */
+        for (int i = 0; i < n; i++) {
+            out[i] = clampf(in[i] / INPUT_GAIN, -0.8f, 0.8f);
+        }
 
-        // fade over lpf poles from 3dB/oct (1P) => 48dB/oct (5P)
-        bx = fade5(b1, b2, b3, b4, b5, slope);
+        rs->upsampleBlock(LOWPASS, out, n, os);
 
-        // saturate and add very low noise to have self oscillation with no input and high res
-        b0 = fastatan(x + noise.getNext(NOISE_GAIN));
+        for (int i = 0; i < n; i++) {
+            if (freqRamp.isRamping()) setCoefficients(freqRamp.next());
 
-        float y = bx * (1 + drive * 40);
+            for (int j = 0; j < factor; j++) {
+                os[i * factor + j] = tick(os[i * factor + j]);
+            }
+        }
+
+        rs->decimateBlock(LOWPASS, os, n, out);
 
-        if (fabs(y) > 1) {
-            lightValue = (lightValue + fabs(y) / 5) / 2;
-        } else {
-            lightValue *= 0.99;
+        for (int i = 0; i < n; i++) {
+            out[i] *= gain;
         }
 
+        lpOut = out[n - 1];
 
-        // overdrive with fast atan, which folds back the waves at high input and creates a noisy bright sound
-        rs->data[LOWPASS][i] = fastatan(y);
+        in += n;
+        out += n;
+        frames -= n;
     }
-
-    lpOut = rs->getDownsampled(LOWPASS) * (INPUT_GAIN / (drive * 20 + 1) * (pow2bpol(drive * 3) + 1));
 }
 
 
@@ -81,12 +153,9 @@ float LadderFilter::getFrequency() const {
 void LadderFilter::setFrequency(float frequency) {
     if (LadderFilter::frequency != frequency) {
         LadderFilter::frequency = frequency;
-        // translate frequency to logarithmic scale
-        freqHz = 20.f * powf(1000.f, frequency);
-        freqExp = clampf(freqHz * (1.f / (sr * OVERSAMPLE / 2.f)), 0.f, 0.9f);
 
         updateResExp();
-        invalidate();
+        markDirty();
     }
 }
 
@@ -117,7 +186,7 @@ void LadderFilter::setResonance(float resonance) {
         LadderFilter::resonance = resonance;
 
         updateResExp();
-        invalidate();
+        markDirty();
     }
 }
 
@@ -140,7 +209,7 @@ void LadderFilter::setDrive(float drive) {
         LadderFilter::drive = clampf(drive, 0.f, 1.f);
 
         updateResExp();
-        invalidate();
+        markDirty();
     }
 }
 
@@ -27,7 +27,12 @@ private:
     Resampler<1> *rs;
     Noise noise;
 
+    /* normalized cutoff, ramped per sample between control rate updates */
+    ControlRamp freqRamp{ControlRamp::EXPONENTIAL};
+
     void updateResExp();
+    void setCoefficients(float freqExp);
+    float tick(float x);
 
 public:
 
@@ -53,6 +58,7 @@ public:
 
     void invalidate() override;
     void process() override;
+    void processBlock(const float *in, float *out, int frames);
 
     float getFrequency() const;
     void setFrequency(float frequency);
@@ -68,5 +74,10 @@ public:
     float getLpOut();
     float getLightValue() const;
     void setLightValue(float lightValue);
+
+
+    double getLatency() override {
+        return rs->getLatency();
+    }
 };
 }
\ No newline at end of file
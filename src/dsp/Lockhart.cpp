@@ -49,8 +49,7 @@ double LockhartWFStage::compute(double x) {
 
 
 LockhartWFStage::LockhartWFStage() {
-    fn1 = 0;
-    xn1 = 0;
+    reset();
 
     a = 2. * LOCKHART_RL / LOCKHART_R;
     b = (LOCKHART_R + 2. * LOCKHART_RL) / (LOCKHART_VT * LOCKHART_R);
@@ -58,6 +57,12 @@ LockhartWFStage::LockhartWFStage() {
 }
 
 
+void LockhartWFStage::reset() {
+    fn1 = 0;
+    xn1 = 0;
+}
+
+
 void LockhartWavefolder::init() {
     lrt::WaveShaper::rs = new lrt::Resampler<1>(1);
 }
@@ -67,6 +72,16 @@ void LockhartWavefolder::invalidate() {
 }
 
 
+void LockhartWavefolder::resetState(int state) {
+    WaveShaper::resetState(state);
+
+    lh1[state].reset();
+    lh2[state].reset();
+    lh3[state].reset();
+    lh4[state].reset();
+}
+
+
 void LockhartWavefolder::process() {
     WaveShaper::process();
 }
@@ -81,12 +96,12 @@ double LockhartWavefolder::compute(double x) {
 
     in *= 0.05;
 
-    in = lh1.compute(in);
-    in = lh2.compute(in);
-    in = lh3.compute(in);
-    in = lh4.compute(in);
+    in = lh1[state].compute(in);
+    in = lh2[state].compute(in);
+    in = lh3[state].compute(in);
+    in = lh4[state].compute(in);
 
-    in = tanh1->next(in) * 2.f;
+    in = tanh1[state]->next(in) * 2.f;
     //if (blockDC) in = dc->lpf(in);
 
     out = in * 10;
@@ -97,6 +112,8 @@ double LockhartWavefolder::compute(double x) {
 
 LockhartWavefolder::LockhartWavefolder(float sr) : WaveShaper(sr) {
     init();
-    tanh1 = new HQTanh(sr, 1);
+    initAdaptive();
+    tanh1[OVERSAMPLED_STATE] = new HQTanh(sr, 1);
+    tanh1[DIRECT_STATE] = new HQTanh(sr, 1);
 }
 
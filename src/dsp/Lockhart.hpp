@@ -27,6 +27,7 @@ public:
     LockhartWFStage();
 
     double compute(double x);
+    void reset();
 };
 
 
@@ -36,7 +37,7 @@ public:
 struct LockhartWavefolder : WaveShaper {
 
 private:
-    LockhartWFStage lh1, lh2, lh3, lh4;
+    LockhartWFStage lh1[NUM_STATES], lh2[NUM_STATES], lh3[NUM_STATES], lh4[NUM_STATES];
 
 public:
     explicit LockhartWavefolder(float sr);
@@ -45,6 +46,9 @@ public:
     void invalidate() override;
     void process() override;
     double compute(double x) override;
+
+protected:
+    void resetState(int state) override;
 };
 
 }
@@ -11,14 +11,25 @@ using rack::logger::log;
 void MS20zdf::invalidate() {
     // translate frequency to logarithmic scale
     //  freqHz = 20.f * powf(860.f, param[FREQUENCY].value) - 20.f;
-    freqHz = 20.f * powf(950.f, param[FREQUENCY].value) - 20.f;
+    freqHz = table->getHz(param[FREQUENCY].value);
 
-    b = tanf(freqHz * (float) M_PI / sr / OVERSAMPLE);
-    g = b / (1 + b);
+    b = table->getG(param[FREQUENCY].value);
 
     /* use shifted negative cubic shape for logarithmic like shaping of the peak parameter */
     k = 2.f * cubicShape(param[PEAK].value) * 1.0001f;
-    g2 = g * g;
+
+    gRamp.set(table->getGain(param[FREQUENCY].value), rampLength);
+    setCoefficients(gRamp.value);
+}
+
+
+/**
+ * @brief Fetch the cutoff table for the new rate before the coefficients are recomputed
+ * @param sr sample rate
+ */
+void MS20zdf::updateSampleRate(float sr) {
+    table = CutoffTable::get(950.f, -20.f, sr * OVERSAMPLE);
+    DSPSystem::updateSampleRate(sr);
 }
 
 
@@ -26,6 +37,9 @@ void MS20zdf::invalidate() {
  * @brief Proccess one sample of filter
  */
 void MS20zdf::process() {
+    update();
+    if (gRamp.isRamping()) setCoefficients(gRamp.next());
+
     //rs.next(IN, input[IN].value);
     rs->doUpsample(IN, input[IN].value);
 
@@ -61,11 +75,79 @@ void MS20zdf::process() {
 }
 
 
+/**
+ * @brief Process a block of samples with the current parameters
+ * @param in Input samples
+ * @param out Output samples
+ * @param frames Number of samples
+ */
+void MS20zdf::processBlock(const float *in, float *out, int frames) {
+    update();
+
+    float *os = rs->getBlockBuffer();
+    int factor = rs->getFactor();
+
+    float s1, s2;
+    float gain = pow2bpol(param[DRIVE].value) * DRIVE_GAIN + 1.f;
+    float type = param[TYPE].value;
+
+    while (frames > 0) {
+        int n = frames < RS_BLOCK_SIZE ? frames : RS_BLOCK_SIZE;
+
+        rs->upsampleBlock(IN, in, n, os);
+
+        for (int i = 0; i < n * factor; i++) {
+            /* coefficients follow the ramp once per host sample, same as process() */
+            if (i % factor == 0 && gRamp.isRamping()) setCoefficients(gRamp.next());
+
+            float x = os[i];
+
+            zdf1.set(x - ky, g);
+            s1 = zdf1.s;
+
+            zdf2.set(zdf1.y + ky, g);
+            s2 = zdf2.s;
+
+            y = 1.f / (g2 * k - g * k + 1.f) * (g2 * x + g * s1 + s2);
+
+            ky = k * atanf(y / 50.f) * 50.f;
+
+            if (type > 0) {
+                os[i] = atanShaper(gain * y / 6.f) * 6.f;
+            } else {
+                os[i] = atanf(gain * y / 6.f) * 6.f;
+            }
+        }
+
+        rs->decimateBlock(IN, os, n, out);
+        output[OUT].value = out[n - 1];
+
+        in += n;
+        out += n;
+        frames -= n;
+    }
+}
+
+
 /**
  * @brief Inherit constructor
  * @param sr sample rate
  */
 MS20zdf::MS20zdf(float sr) : DSPSystem(sr) {
-    rs = new Resampler<1>(OVERSAMPLE, 8);
+    table = CutoffTable::get(950.f, -20.f, sr * OVERSAMPLE);
+
+    linear = new Resampler<1>(OVERSAMPLE, 8);
+    minimum = new Resampler<1>(OVERSAMPLE, 8, Resampler<1>::MINPHASE);
+    rs = linear;
+}
+
+
+void MS20zdf::setLowLatency(bool lowLatency) {
+    Resampler<1> *next = lowLatency ? minimum : linear;
+    if (next == rs) return;
+
+    /* start with clean histories, the other resampler is stale */
+    next->reset();
+    rs = next;
 }
 
@@ -19,6 +19,7 @@
 
 #include "DSPSystem.hpp"
 #include "DSPMath.hpp"
+#include "CutoffTable.hpp"
 
 namespace lrt {
 
@@ -88,6 +89,19 @@ private:
 
     MS20ZDF zdf1, zdf2;
     Resampler<1> *rs;
+    Resampler<1> *linear, *minimum;
+
+    /* warped cutoff g, ramped per sample between control rate updates */
+    ControlRamp gRamp{ControlRamp::EXPONENTIAL};
+
+    /* shared cutoff table at the oversampled rate, 20Hz * 950^fc - 20Hz */
+    const CutoffTable *table;
+
+
+    inline void setCoefficients(float g) {
+        MS20zdf::g = g;
+        g2 = g * g;
+    }
 
 public:
     explicit MS20zdf(float sr);
@@ -148,8 +162,27 @@ public:
     }
 
 
+    /**
+     * @brief Switch to the minimum phase resampler, which keeps the delay in feedback patches short
+     * @param lowLatency
+     */
+    void setLowLatency(bool lowLatency);
+
+
+    bool isLowLatency() const {
+        return rs == minimum;
+    }
+
+
+    double getLatency() override {
+        return rs->getLatency();
+    }
+
+
+    void updateSampleRate(float sr) override;
     void invalidate() override;
     void process() override;
+    void processBlock(const float *in, float *out, int frames);
 };
 
 
@@ -9,17 +9,17 @@ using namespace lrt;
  * @param sr SampleRate
  */
 DSPBLOscillator::DSPBLOscillator(float sr) : DSPSystem(sr) {
-    lfo = new DSPSineLFO(sr);
+    /* the drift LFO is stepped once per control tick */
+    lfo = new DSPSineLFO(sr / CONTROL_RATE);
     reset();
 }
 
 
 /**
- * @brief Trigger recalculation of internal state
+ * @brief Trigger recalculation of internal state, e.g. on samplerate changes
  */
 void DSPBLOscillator::invalidate() {
-    incr = getPhaseIncrement(param[FREQUENCY].value, sr);
-    n = floorf(sr * 0.5 / param[FREQUENCY].value);
+    updateTargets(true);
 }
 
 
@@ -27,11 +27,33 @@ void DSPBLOscillator::invalidate() {
  * @brief Process one sample
  */
 void DSPBLOscillator::process() {
+    /* pending recalculations first, they would cancel the ramps started by updatePitch() */
+    update();
     updatePitch();
 
     /* phase locked loop */
     phase = wrapTWOPI(incr + phase);
 
+    if (core == POLYBLEP) processPolyBLEP();
+    else processBLIT();
+
+    /* compute sine */
+    output[SINE].value = fastSin(phase) * 5.f;
+
+    /* compute noise: act as S&H in LFO mode, update getNext random only every cycle */
+    if (!lfoMode || phase - incr <= -M_PI)
+        output[NOISE].value = noise.getNext(10.f) - 5.f;
+
+}
+
+
+/**
+ * @brief SAW, PULSE and TRI out of two impulse trains and three leaky integrators
+ */
+void DSPBLOscillator::processBLIT() {
+    /* harmonics up to nyquist */
+    float n = floorf(PI / incr);
+
     /* pulse width */
     float w = param[PULSEWIDTH].value * PI;
 
@@ -60,14 +82,36 @@ void DSPBLOscillator::process() {
 
     /* compute triangle */
     output[TRI].value = beta * 5.f;
+}
 
-    /* compute sine */
-    output[SINE].value = fastSin(phase) * 5.f;
 
-    /* compute noise: act as S&H in LFO mode, update getNext random only every cycle */
-    if (!lfoMode || phase - incr <= -M_PI)
-        output[NOISE].value = noise.getNext(10.f) - 5.f;
+/**
+ * @brief SAW, PULSE and TRI as trivial waveforms with polyBLEP / polyBLAMP residuals at the edges
+ *
+ * Levels and phase follow the BLIT core: the saw falls at phase 0, the pulse is DC free and rises
+ * at phase 0, the triangle is the integrated pulse with its minimum at phase 0.
+ */
+void DSPBLOscillator::processPolyBLEP() {
+    /* normalized phase 0..1 and increment */
+    float t = phase * (1.f / TWOPI);
+    if (t < 0.f) t += 1.f;
+
+    float dt = incr * (1.f / TWOPI);
+
+    /* duty cycle and phase relative to the falling edge */
+    float d = 1.f - param[PULSEWIDTH].value * 0.5f;
+    float t2 = t - d;
+    if (t2 < 0.f) t2 += 1.f;
 
+    float blep = polyBLEP(t, dt) - polyBLEP(t2, dt);
+    float blamp = polyBLAMP(t, dt) - polyBLAMP(t2, dt);
+
+    output[SAW].value = (t + t - 1.f - polyBLEP(t, dt)) * (1.25f * PI);
+    output[PULSE].value = ((t < d ? 1.f - d : -d) * 2.f + blep) * PI;
+
+    /* peak at the falling edge, the slope changes by 12 PI at both corners */
+    float tri = t < d ? t * (1.f - d) : (1.f - t) * d;
+    output[TRI].value = (tri * 12.f - 6.f * d * (1.f - d) + 6.f * dt * blamp) * PI;
 }
 
 
@@ -75,100 +119,139 @@ void DSPBLOscillator::reset() {
     param[FREQUENCY].value = 0.f;
     param[PULSEWIDTH].value = 1.f;
     phase = 0.f;
-    incr = 0.f;
     detune = noise.getNext(DETUNE_AMOUNT);
     drift = 0.f;
-    warmup = 0.f;
     warmupTau = sr * 1.5f;
     tick = round(sr * 0.7f);
+    warmup = 1 - fastExp2(-tick / warmupTau * (float) M_LOG2E);
 
     lfo->reset();
     lfo->setPhase(noise.getNext(TWOPI));
     lfo->setFrequency(DRIFT_FREQ + noise.getNext(DRIFT_VARIANZ));
 
-    n = 0;
+    /* the first sample starts the ramps */
+    controlTick = 0;
+
+    lfoMode = false;
+    _lfoMode = false;
 
     _cv = 0.f;
     _oct = 0.f;
 
     _base = 1.f;
     _coeff = 1.f;
-    _tune = 0.f;
-    _biqufm = 0.f;
 
-    /* force recalculation of variables */
-    setParam(FREQUENCY, NOTE_C4 + detune, true);
+    /* start at the target pitch without ramping */
+    updateTargets(true);
+    incr = clampf(offset, incrMin, incrMax);
 }
 
 
 /**
- * @brief Constructs the correct pitch in Hz out of all parameters
- * @param cv V/OCT CVs
- * @param fm Frequency modulation CVs
- * @param tune Tune knob value
- * @param oct Octave knob value
+ * @brief Step warmup and drift, called once per control tick
  */
-void DSPBLOscillator::updatePitch() {
-    // CV is at 1V/OCt, C0 = 16.3516Hz, C4 = 261.626Hz
-    // 10.3V = 20614.33hz
+void DSPBLOscillator::updateControl() {
+    controlTick = CONTROL_RATE;
 
     // give it 30s to warmup
-    if (tick++ < sr * 30) {
-        if (tick < sr * 1.8f) {
-            tick += 6; // accelerated detune
-            warmup = 1 - powf((float) M_E, -(tick / warmupTau));
-        } else
-            warmup = 1 - powf((float) M_E, -(tick / warmupTau));
+    if (tick < sr * 30) {
+        tick += (tick < sr * 1.8f ? 7 : 1) * CONTROL_RATE; // accelerated detune
+        warmup = 1 - fastExp2(-tick / warmupTau * (float) M_LOG2E);
     }
 
     lfo->process();
     drift = lfo->getSine() * DRIFT_AMOUNT;
 
+    updateTargets(false);
+}
+
+
+/**
+ * @brief Compute offset and scale of the phase increment out of V/Oct, octave, drift and warmup
+ * @param jump Apply at once, otherwise ramp towards them until the next control tick
+ */
+void DSPBLOscillator::updateTargets(bool jump) {
+    // CV is at 1V/OCt, C0 = 16.3516Hz, C4 = 261.626Hz
+    // 10.3V = 20614.33hz
     float cv = input[VOCT1].value + input[VOCT2].value;
-    float fm;
-    float tune;
-    float oct;
+    float oct = input[OCTAVE].value;
+
+    /* the exponentials are only evaluated on changes */
+    if (cv != _cv) {
+        _cv = cv;
+        _base = fastExp2(cv);
+    }
+
+    if (oct != _oct) {
+        _oct = oct;
+        _coeff = fastExp2(oct);
+    }
+
+    _lfoMode = lfoMode;
+
+    float k = TWOPI / sr;
+
+    incrMin = 0.00001f * k;
+    incrMax = 18000.f * k;
+
+    float scaleTarget, offsetTarget;
 
     if (lfoMode) {
-        /* convert knob value to unipolar */
-        fm = input[FM_CV].value;
-        tune = pow2bpol((input[TUNE].value + 1) / 2);
-        tune *= LFO_SCALE;
-        fm *= LFO_SCALE;
-        oct = -8;
+        scaleTarget = k;
+        offsetTarget = 0.f;
     } else {
-        fm = input[FM_CV].value * TUNE_SCALE;
-        tune = input[TUNE].value * TUNE_SCALE;
-        oct = input[OCTAVE].value;
+        scaleTarget = _base * _coeff * warmup * k;
+        offsetTarget = (NOTE_C4 + drift + detune) * scaleTarget;
     }
 
-    /* optimize the usage of expensive exp function and other computations */
-    float coeff = (_oct != oct) ? powf(2.f, oct) : _coeff;
-    float base = (_cv != cv) ? powf(2.f, cv) : _base;
-    float biqufm = (_tune != tune + fm) ? pow2bpol(tune + fm) : _biqufm;
-
-    if (lfoMode)
-        setFrequency(tune + fm);
-    else
-        setFrequency((NOTE_C4 + drift + detune + biqufm) * base * coeff * warmup);
-
-    /* save states */
-    _cv = cv;
-    _oct = oct;
-    _base = base;
-    _coeff = coeff;
-    _tune = tune + fm;
-    _biqufm = biqufm;
+    if (jump) {
+        offset = offsetTarget;
+        scale = scaleTarget;
+        offsetStep = 0.f;
+        scaleStep = 0.f;
+    } else {
+        offsetStep = (offsetTarget - offset) * (1.f / CONTROL_RATE);
+        scaleStep = (scaleTarget - scale) * (1.f / CONTROL_RATE);
+    }
 }
 
 
-void DSPBLOscillator::setFrequency(float frq) {
-    setParam(FREQUENCY, clampf(frq, 0.00001f, 18000.f), true);
+/**
+ * @brief Constructs the phase increment out of all inputs
+ *
+ * V/Oct, octave, drift and warmup are handled at control rate, V/Oct and octave changes beyond
+ * CV_EPSILON apply at once. Per sample only the ramps and the FM are computed.
+ */
+void DSPBLOscillator::updatePitch() {
+    float cv = input[VOCT1].value + input[VOCT2].value;
+
+    if (fabsf(cv - _cv) > CV_EPSILON || input[OCTAVE].value != _oct || lfoMode != _lfoMode) {
+        updateTargets(true);
+    }
+
+    if (--controlTick <= 0) {
+        updateControl();
+    }
+
+    offset += offsetStep;
+    scale += scaleStep;
+
+    float x;
+
+    if (lfoMode) {
+        /* convert knob value to unipolar */
+        x = pow2bpol((input[TUNE].value + 1) / 2) * LFO_SCALE + input[FM_CV].value * LFO_SCALE;
+    } else {
+        x = pow2bpol((input[TUNE].value + input[FM_CV].value) * TUNE_SCALE);
+    }
+
+    incr = clampf(offset + x * scale, incrMin, incrMax);
 }
 
 
 void DSPBLOscillator::setPulseWidth(float width) {
-    setParam(PULSEWIDTH, width, true);
+    /* read directly by the cores, nothing to recalculate */
+    setParam(PULSEWIDTH, width, false);
 }
 
 
@@ -185,11 +268,11 @@ void DSPBLOscillator::setInputs(float voct1, float voct2, float fm, float tune,
 
 
 /**
- * @brief Pass changed samplerate to LFO
+ * @brief Pass changed samplerate to LFO, which runs at control rate
  * @param sr
  */
 void DSPBLOscillator::updateSampleRate(float sr) {
     DSPSystem::updateSampleRate(sr);
-    lfo->updateSampleRate(sr);
+    lfo->updateSampleRate(sr / CONTROL_RATE);
 }
 
@@ -52,6 +52,8 @@ public:
 
 
     void process() override {
+        update();
+
         phase = wrapTWOPI(phase + frac);
         output[SINE].value = fastSin(phase);
     }
@@ -105,7 +107,7 @@ public:
      * @param x Input value
      * @return Current of integrator
      */
-    float add(float x, float leak) {
+    float add(float x, float /* leak, fixed at 0.999 */) {
         param[LEAK].value = 0.999;
         input[IN].value = x;
         process();
@@ -132,6 +134,12 @@ struct DSPBLOscillator : DSPSystem<5, 6, 10> {
     //static constexpr float BLIT_HARMONICS = 22050.f;
     static constexpr float NOTE_C4 = 261.626f;
 
+    /* samples per control tick of drift and warmup */
+    static const int CONTROL_RATE = 32;
+
+    /* V/Oct changes above this apply at once instead of at the next control tick */
+    static constexpr float CV_EPSILON = 0.0001f;
+
     enum Inputs {
         VOCT1, VOCT2,
         FM_CV,
@@ -152,7 +160,17 @@ struct DSPBLOscillator : DSPSystem<5, 6, 10> {
         PULSEWIDTH
     };
 
+    /**
+     * Waveform generation, the pitch path (drift, warmup) is the same for both
+     */
+    enum Core {
+        INTEGRATED_BLIT,    // BLIT through leaky integrators, analogue like curved waveforms
+        POLYBLEP            // trivial waveforms corrected by polyBLEP / polyBLAMP, much cheaper
+    };
+
 private:
+    Core core = INTEGRATED_BLIT;
+
     float phase;     // current phase
     float incr;      // current phase increment for PLL
     float detune;    // analogue detune
@@ -160,7 +178,7 @@ private:
     float warmup;    // oscillator warmup detune
     float warmupTau; // time factor for warmup detune
     int tick;
-    int n;
+    int controlTick; // samples until the next control tick
     bool lfoMode;    // LFO mode?
     Noise noise;     // randomizer
 
@@ -173,8 +191,17 @@ private:
 
     void reset();
 
+    void updateControl();
+    void updateTargets(bool jump);
+
     /* saved frequency states */
-    float _cv, _oct, _base, _coeff, _tune, _biqufm;
+    float _cv, _oct, _base, _coeff;
+    bool _lfoMode;
+
+    /* phase increment = offset + shape(tune + fm) * scale, both ramped between control ticks */
+    float offset, offsetStep;
+    float scale, scaleStep;
+    float incrMin, incrMax;
 
 
 public:
@@ -182,13 +209,11 @@ public:
 
     void updatePitch();
 
-    void setFrequency(float frq);
-
 
     void setInputs(float voct1, float voct2, float fm, float tune, float oct);
 
 
-    float getFrequency() { return param[FREQUENCY].value; }
+    float getFrequency() { return incr * sr / TWOPI; }
 
 
     bool isLFO() {
@@ -199,6 +224,16 @@ public:
     void setPulseWidth(float width);
 
 
+    void setCore(Core core) {
+        DSPBLOscillator::core = core;
+    }
+
+
+    Core getCore() const {
+        return core;
+    }
+
+
     float getSawWave() {
         return getOutput(SAW);
     }
@@ -226,6 +261,9 @@ public:
 
     void updateSampleRate(float sr) override;
 
+    void processBLIT();
+    void processPolyBLEP();
+
     void invalidate() override;
     void process() override;
 };
@@ -5,8 +5,10 @@ using namespace lrt;
 
 Overdrive::Overdrive(float sr) : WaveShaper(sr) {
     init();
+    initAdaptive();
     noise = new Noise;
-    tanh1 = new HQTanh(sr, 1);
+    tanh1[OVERSAMPLED_STATE] = new HQTanh(sr, 1);
+    tanh1[DIRECT_STATE] = new HQTanh(sr, 1);
 }
 
 
@@ -32,7 +34,7 @@ double Overdrive::compute(double x) {
 
     in *= OVERDRIVE_GAIN;
 
-    in = tanh1->next(in * 1.5) * 1.5;
+    in = tanh1[state]->next(in * 1.5) * 1.5;
 
     double a = clampd(gain / 20, 0., .999999);
 
@@ -5,6 +5,7 @@ using namespace lrt;
 
 ReShaper::ReShaper(float sr) : WaveShaper(sr) {
     init();
+    initAdaptive();
     noise = new Noise;
 }
 
@@ -34,7 +35,7 @@ double ReShaper::compute(double x) {
     in = in * (fabs(in) + a) / (in * in + (a - 1) * fabs(in) + 1);
 
     in *= 1 / RSHAPER_GAIN * 0.5;
-    if (blockDC) in = dc->filter(in);
+    if (blockDC) in = dc[state]->filter(in);
 
     out = in;
 
@@ -18,125 +18,198 @@
 
 #pragma once
 
-namespace lrt {
+#include "DSPSimd.hpp"
+#include "ResamplerKernel.hpp"
 
-class RateConverter {
-public:
-    RateConverter(void);
-    virtual ~RateConverter(void);
+#define NEO_MAX_RATIO 16
+#define NEO_DEFAULT_STOPBAND 80.
+#define NEO_DEFAULT_TRANSITION 0.1
 
-    // buffer for the impulse response h[n] of the FIR
-    float *irBuffer;
+namespace lrt {
 
-    // buffers for the transversal delay lines, one for each input
-    float *inputBuffer;
-    //  float *m_pRightInputBuffer;
+/**
+ * @brief Kaiser window parameter for a given stopband attenuation
+ * @param stopband Attenuation in dB
+ * @return
+ */
+double kaiserBeta(double stopband);
 
-    // read index for delay lines (input x buffers)
-    int delayPos;
 
-    // read index for impulse response buffers
-    int irBufferPos;
+/**
+ * @brief Estimated number of taps for a Kaiser windowed FIR
+ * @param stopband Attenuation in dB
+ * @param transition Width of the transition band relative to the sample rate
+ * @return
+ */
+int kaiserLength(double stopband, double transition);
 
-    // write index for input x buffer
-    int inputPos;
 
-    int ratio; // OS value, 4 = 4X Oversampling
+/**
+ * @brief Computes a Kaiser windowed-sinc lowpass
+ * @param out Impulse response, length len
+ * @param len Number of taps
+ * @param cutoff Cutoff relative to the sample rate
+ * @param beta Kaiser window parameter
+ */
+void kaiserLowpassIR(double *out, int len, double cutoff, double beta);
+
 
-    // counters and index values for the convolutions
-    int osPos;
-    int length;
+/**
+ * @brief Polyphase oversampler with a Kaiser FIR designed at runtime
+ *
+ * The ratio could be 2, 4, 8 or 16. The filter is designed for the given stopband attenuation with the
+ * passband ending at 0.5 - transition and the stopband starting at the host nyquist frequency. Both
+ * directions work on mirrored float histories, the inner loops are instantiated per ratio and run a
+ * 4 lane SIMD dot product. The minimum phase option trades the linear phase for a fraction of the
+ * latency and less taps.
+ */
+class NeoOversampler {
+public:
+    bool enabled;
 
-    // initializer - creates the buffers and loads the FIR IR
-    void init(int _ratio, int _length, float *pIRBuffer);
 
-    // flush buffers
+    /**
+     * @brief Constructor
+     * @param ratio Oversampling ratio, 2, 4, 8 or 16
+     * @param stopband Stopband attenuation in dB
+     * @param transition Width of the transition band relative to the host rate
+     * @param minimumPhase Use a minimum phase filter
+     */
+    explicit NeoOversampler(int ratio = 4, double stopband = NEO_DEFAULT_STOPBAND, double transition = NEO_DEFAULT_TRANSITION,
+                            bool minimumPhase = false);
+    virtual ~NeoOversampler();
+
+    NeoOversampler(const NeoOversampler &) = delete;
+    NeoOversampler &operator=(const NeoOversampler &) = delete;
+
+
+    /**
+     * @brief Redesign the filter, clears all histories
+     * @param ratio Oversampling ratio, 2, 4, 8 or 16
+     * @param stopband Stopband attenuation in dB
+     * @param transition Width of the transition band relative to the host rate
+     * @param minimumPhase Use a minimum phase filter
+     */
+    void init(int ratio, double stopband = NEO_DEFAULT_STOPBAND, double transition = NEO_DEFAULT_TRANSITION, bool minimumPhase = false);
     void reset();
 
+    int getRatio() const;
+    double getStopband() const;
+    int getLength() const;
+    bool isMinimumPhase() const;
 
-    // overrides for derived objects
-    //
-    // interpolateSamples: take one pair of L/R samples and produce L-length buffers of samples
-    virtual void interpolateSamples(float xnL, float *pLeftInterpBuffer) {};
 
+    /**
+     * @brief Group delay of the upsample -> downsample path in samples at the host rate
+     * @return
+     */
+    double getLatency() const;
 
-    // inner loop function that processes just one pair of inputs
-    virtual void interpolateNextOutputSample(float xnL, float &fLeftOutput) {};
 
+    /**
+     * @brief Upsample one input sample
+     * @param x Input sample
+     * @param out Oversampled output, must be length ratio
+     */
+    void upsample(float x, float *out);
 
-    // decimateSamples: take one pai rL-length buffers of samples and decimate down to just one pair of output samples
-    virtual void decimateSamples(float *pLeftDeciBuffer, float &ynL) {};
 
+    /**
+     * @brief Downsample one frame of oversampled samples
+     * @param in Oversampled input, must be length ratio
+     * @return Output sample
+     */
+    float downsample(const float *in);
 
-    // inner loop function that processes just one pair of inputs
-    virtual bool decimateNextOutputSample(float xnL, float &fLeftOutput) { return true; };
-};
 
+    /**
+     * @brief To be implemented by subclass, computed at the oversampled rate
+     * @param x Input sample
+     * @return Output sample
+     */
+    virtual float process(float x) { return x; };
 
-class Decimator : public RateConverter {
-public:
-    Decimator(void);
-    ~Decimator(void);
 
-    bool decimateNextOutputSample(float x, float &out) override;
-    void decimateSamples(float *buffer, float &out) override;
-};
+    /**
+     * @brief Runs process() oversampled
+     * @param x Input sample
+     * @return Output sample
+     */
+    float compute(float x);
 
 
-class Interpolator : public RateConverter {
-public:
-    Interpolator(void);
-    ~Interpolator(void);
+    /**
+     * @brief Runs shaper.process() oversampled. Passing the concrete (final) shaper type avoids the
+     * virtual call per oversampled sample.
+     * @param shaper Object with a float process(float) method
+     * @param x Input sample
+     * @return Output sample
+     */
+    template<typename T>
+    inline float compute(T &shaper, float x) {
+        if (!enabled) return shaper.process(x);
 
-    void interpolateNextOutputSample(float x, float &fLeftOutput) override;
-    void interpolateSamples(float x, float *buffer) override;
+        upsample(x, buffer);
 
-};
+        for (int i = 0; i < ratio; i++) {
+            buffer[i] = shaper.process(buffer[i]);
+        }
 
+        return downsample(buffer);
+    }
 
-/**
- * @brief New oversampling class that uses polyphase
- */
-class NeoOversampler {
 private:
-    int irSize;
-    float irBuffer[1024];
-    int ratio = 4;
-
-    void init();
+    int ratio;
+    double stopband, transition;
+    bool minimumPhase;
+    double latency;
 
-    Interpolator interpolator;
-    Decimator decimator;
-
-    float *interpBuffer;
-    float *decimBuffer;
+    /* prototype length, ratio * phaseLength */
+    int length;
 
-public:
-    bool enabled;
+    /* taps per polyphase branch, multiple of the SIMD width */
+    int phaseLength;
 
-    NeoOversampler();
+    /* polyphase branches (ratio x phaseLength, time-reversed) and the time-reversed prototype */
+    float *phases;
+    float *kernel;
 
+    /* mirrored histories */
+    float *upBuffer;
+    float *downBuffer;
+    int upIndex, downIndex;
 
-    virtual float process(float x) { return x; };
+    float buffer[NEO_MAX_RATIO];
 
-    float compute(float x);
+    template<int RATIO>
+    void upsampleRatio(float x, float *out);
 
+    template<int RATIO>
+    float downsampleRatio(const float *in);
 };
 
 
 /**
- * @brief Just for test!
+ * @brief Oversampled error function shaper
  */
-struct TanhOS : NeoOversampler {
+struct TanhOS final : NeoOversampler {
 
     float gain = 0.f;
 
-    TanhOS();
+    explicit TanhOS(int ratio = 4);
 
-    virtual float process(float x) override;
+    float process(float x) override;
 
+
+    /**
+     * @brief Compute next sample, calls process() without virtual dispatch
+     * @param x
+     * @return
+     */
+    float next(float x) {
+        return NeoOversampler::compute(*this, x);
+    }
 };
 
 
 }
-
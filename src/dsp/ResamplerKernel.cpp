@@ -0,0 +1,293 @@
+/*                                                                     *\
+**       __   ___  ______                                              **
+**      / /  / _ \/_  __/                                              **
+**     / /__/ , _/ / /    Lindenberg                                   **
+**    /____/_/|_| /_/  Research Tec.                                   **
+**                                                                     **
+**                                                                     **
+**	  https://github.com/lindenbergresearch/LRTRack	                   **
+**    heapdump@icloud.com                                              **
+**		                                                               **
+**    Sound Modules for VCV Rack                                       **
+**    Copyright 2017-2019 by Patrick Lindenberg / LRT                  **
+**                                                                     **
+**    For Redistribution and use in source and binary forms,           **
+**    with or without modification please see LICENSE.                 **
+**                                                                     **
+\*                                                                     */
+#include <complex>
+#include <mutex>
+#include <vector>
+#include "ResamplerKernel.hpp"
+#include "DSPEffect.hpp"
+
+namespace lrt {
+
+/**
+ * @brief Compile time generation of the windowed-sinc kernels (C++11 constexpr)
+ */
+namespace kernel {
+
+constexpr double PI_D = 3.14159265358979323846;
+
+
+constexpr double floorc(double x) {
+    return (x < 0 && (double) (long long) x != x) ? (double) ((long long) x - 1) : (double) (long long) x;
+}
+
+
+/* reduce the argument to -PI..PI */
+constexpr double wrap(double x) {
+    return x - 2. * PI_D * floorc((x + PI_D) / (2. * PI_D));
+}
+
+
+constexpr double sinTaylor(double x2, double term, int n, double sum) {
+    return n > 30 ? sum : sinTaylor(x2, -term * x2 / ((2. * n) * (2. * n + 1.)), n + 1, sum + term);
+}
+
+
+constexpr double cosTaylor(double x2, double term, int n, double sum) {
+    return n > 30 ? sum : cosTaylor(x2, -term * x2 / ((2. * n - 1.) * (2. * n)), n + 1, sum + term);
+}
+
+
+constexpr double sinc(double x) {
+    return x == 0. ? 1. : sinTaylor(wrap(PI_D * x) * wrap(PI_D * x), wrap(PI_D * x), 1, 0.) / (PI_D * x);
+}
+
+
+constexpr double cosc(double x) {
+    return cosTaylor(wrap(x) * wrap(x), 1., 1, 0.);
+}
+
+
+/* same as boxcarLowpassIR() * blackmanHarrisWindow() for a single tap */
+constexpr double tap(int i, int len, double cutoff) {
+    return 2. * cutoff * sinc(2. * cutoff * (i - (len - 1) / 2.)) *
+           (len < 2 ? 1. :
+            0.35875
+            - 0.48829 * cosc(1. * 2. * PI_D / (len - 1) * i)
+            + 0.14128 * cosc(2. * 2. * PI_D / (len - 1) * i)
+            - 0.01168 * cosc(3. * 2. * PI_D / (len - 1) * i));
+}
+
+
+template<int... I>
+struct Sequence {
+};
+
+template<int N, int... I>
+struct MakeSequence : MakeSequence<N - 1, N - 1, I...> {
+};
+
+template<int... I>
+struct MakeSequence<0, I...> {
+    typedef Sequence<I...> type;
+};
+
+
+/**
+ * @brief Kernel table for a fixed configuration with cutoff = 0.65
+ */
+template<int OVERSAMPLE, int QUALITY, typename S = typename MakeSequence<OVERSAMPLE * QUALITY>::type>
+struct Table;
+
+template<int OVERSAMPLE, int QUALITY, int... I>
+struct Table<OVERSAMPLE, QUALITY, Sequence<I...>> {
+    static constexpr double data[sizeof...(I)] = {tap(I, OVERSAMPLE * QUALITY, 0.65 * 0.5 / OVERSAMPLE)...};
+};
+
+template<int OVERSAMPLE, int QUALITY, int... I>
+constexpr double Table<OVERSAMPLE, QUALITY, Sequence<I...>>::data[sizeof...(I)];
+
+
+struct Entry {
+    int oversample, quality;
+    const double *ir;
+};
+
+
+/* configurations used across the plugin */
+static const Entry PRECOMPUTED[] = {
+        {1, 4,  Table<1, 4>::data},
+        {2, 4,  Table<2, 4>::data},
+        {4, 4,  Table<4, 4>::data},
+        {4, 8,  Table<4, 8>::data},
+        {4, 16, Table<4, 16>::data},
+        {8, 16, Table<8, 16>::data},
+};
+
+static const double DEFAULT_CUTOFF = 0.65;
+
+}
+
+
+/* share of the taps kept by the minimum phase kernels */
+static const double MINPHASE_TAPS = 0.75;
+
+
+/**
+ * @brief In place radix-2 FFT, n has to be a power of two
+ */
+static void fft(std::complex<double> *x, int n, bool inverse) {
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+
+        if (i < j) std::swap(x[i], x[j]);
+    }
+
+    for (int len = 2; len <= n; len <<= 1) {
+        double angle = 2. * M_PI / len * (inverse ? 1. : -1.);
+        std::complex<double> wl(cos(angle), sin(angle));
+
+        for (int i = 0; i < n; i += len) {
+            std::complex<double> w(1.);
+
+            for (int j = 0; j < len / 2; j++) {
+                std::complex<double> u = x[i + j];
+                std::complex<double> v = x[i + j + len / 2] * w;
+
+                x[i + j] = u + v;
+                x[i + j + len / 2] = u - v;
+                w *= wl;
+            }
+        }
+    }
+
+    if (inverse) {
+        for (int i = 0; i < n; i++) x[i] /= (double) n;
+    }
+}
+
+
+void minimumPhaseIR(double *ir, int len) {
+    /* large zero padding keeps the cepstrum from aliasing */
+    int n = 1;
+    while (n < 8 * len) n <<= 1;
+
+    std::vector<std::complex<double>> x(n);
+
+    for (int i = 0; i < len; i++) x[i] = ir[i];
+
+    /* real cepstrum of the magnitude response, floor at -200dB for the zeros in the stopband */
+    fft(x.data(), n, false);
+    for (int i = 0; i < n; i++) x[i] = log(fmax(std::abs(x[i]), 1e-10));
+    fft(x.data(), n, true);
+
+    /* fold the anti-causal part onto the causal part */
+    for (int i = 1; i < n / 2; i++) {
+        x[i] *= 2.;
+        x[n - i] = 0.;
+    }
+
+    fft(x.data(), n, false);
+    for (int i = 0; i < n; i++) x[i] = exp(x[i]);
+    fft(x.data(), n, true);
+
+    for (int i = 0; i < len; i++) ir[i] = x[i].real();
+}
+
+
+double groupDelay(const double *ir, int len) {
+    double sum = 0., moment = 0.;
+
+    for (int i = 0; i < len; i++) {
+        sum += ir[i];
+        moment += i * ir[i];
+    }
+
+    return moment / sum;
+}
+
+
+ResamplerKernel::ResamplerKernel(int oversample, int quality, double cutoff, bool minimumPhase, int taps, const double *ir) {
+    ResamplerKernel::oversample = oversample;
+    ResamplerKernel::quality = quality;
+    ResamplerKernel::cutoff = cutoff;
+    ResamplerKernel::minimumPhase = minimumPhase;
+    ResamplerKernel::taps = taps;
+    ResamplerKernel::ir = ir;
+
+    length = oversample * taps;
+    delay = groupDelay(ir, length);
+
+    double *r = new double[length];
+    double *p = new double[length];
+    float *rf = new float[length];
+    float *pf = new float[length];
+
+    for (int i = 0; i < length; i++) {
+        r[i] = ir[length - 1 - i];
+        rf[i] = (float) r[i];
+    }
+
+    for (int i = 0; i < oversample; i++) {
+        for (int j = 0; j < taps; j++) {
+            p[i * taps + (taps - 1 - j)] = ir[oversample * j + i];
+            pf[i * taps + (taps - 1 - j)] = (float) ir[oversample * j + i];
+        }
+    }
+
+    reversed = r;
+    phases = p;
+    reversedf = rf;
+    phasesf = pf;
+}
+
+
+const ResamplerKernel *ResamplerKernel::get(int oversample, int quality, double cutoff, bool minimumPhase) {
+    /* recursive, the minimum phase kernels are derived from the linear phase ones */
+    static std::recursive_mutex lock;
+    static std::vector<const ResamplerKernel *> kernels;
+
+    std::lock_guard<std::recursive_mutex> guard(lock);
+
+    for (auto k : kernels) {
+        if (k->oversample == oversample && k->quality == quality && k->cutoff == cutoff && k->minimumPhase == minimumPhase) return k;
+    }
+
+    /* derived from the linear phase kernel and cut down to the part which holds the energy */
+    if (minimumPhase) {
+        int length = oversample * quality;
+        int taps = (int) ceil(quality * MINPHASE_TAPS);
+        double *buffer = new double[length];
+
+        memcpy(buffer, get(oversample, quality, cutoff, false)->ir, length * sizeof(double));
+        minimumPhaseIR(buffer, length);
+
+        auto k = new ResamplerKernel(oversample, quality, cutoff, true, taps, buffer);
+        kernels.push_back(k);
+
+        return k;
+    }
+
+    const double *ir = nullptr;
+
+    /* use a compile time table if there is one */
+    if (cutoff == kernel::DEFAULT_CUTOFF) {
+        for (auto &e : kernel::PRECOMPUTED) {
+            if (e.oversample == oversample && e.quality == quality) ir = e.ir;
+        }
+    }
+
+    /* otherwise design it now */
+    if (ir == nullptr) {
+        double *buffer = new double[oversample * quality];
+
+        boxcarLowpassIR(buffer, oversample * quality, cutoff * 0.5 / oversample);
+        blackmanHarrisWindow(buffer, oversample * quality);
+
+        ir = buffer;
+    }
+
+    auto k = new ResamplerKernel(oversample, quality, cutoff, false, quality, ir);
+    kernels.push_back(k);
+
+    return k;
+}
+
+}
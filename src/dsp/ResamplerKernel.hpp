@@ -0,0 +1,88 @@
+/*                                                                     *\
+**       __   ___  ______                                              **
+**      / /  / _ \/_  __/                                              **
+**     / /__/ , _/ / /    Lindenberg                                   **
+**    /____/_/|_| /_/  Research Tec.                                   **
+**                                                                     **
+**                                                                     **
+**	  https://github.com/lindenbergresearch/LRTRack	                   **
+**    heapdump@icloud.com                                              **
+**		                                                               **
+**    Sound Modules for VCV Rack                                       **
+**    Copyright 2017-2019 by Patrick Lindenberg / LRT                  **
+**                                                                     **
+**    For Redistribution and use in source and binary forms,           **
+**    with or without modification please see LICENSE.                 **
+**                                                                     **
+\*                                                                     */
+#pragma once
+
+namespace lrt {
+
+/**
+ * @brief Shared, read-only lowpass kernel used by the resampling filters
+ *
+ * Kernels are looked up by (oversample, quality, cutoff) and created only once per process, so all
+ * filter instances and channels with the same configuration point to the same memory. The common
+ * configurations are generated at compile time, others are designed on first use.
+ *
+ * The minimum phase variant has the same magnitude response but most of its energy at the start,
+ * so it is cut down to MINPHASE_TAPS of the taps and delays much less than the linear phase kernel.
+ */
+struct ResamplerKernel {
+    int oversample, quality, length;
+    double cutoff;
+    bool minimumPhase;
+
+    /* taps per polyphase branch, length = oversample * taps */
+    int taps;
+
+    /* group delay at DC in samples at the oversampled rate */
+    double delay;
+
+    /* windowed-sinc impulse response, length taps */
+    const double *ir;
+
+    /* time-reversed impulse response, used by the decimators */
+    const double *reversed;
+
+    /* polyphase sub-filters (oversample x quality), each stored time-reversed */
+    const double *phases;
+
+    /* float versions of reversed and phases, used by the SIMD resamplers */
+    const float *reversedf;
+    const float *phasesf;
+
+
+    /**
+     * @brief Get the shared kernel for a configuration, creates it on first use
+     * @param oversample Oversampling factor
+     * @param quality Kernel length per sample
+     * @param cutoff Cutoff relative to the host nyquist frequency
+     * @param minimumPhase Use the minimum phase version of the kernel
+     * @return
+     */
+    static const ResamplerKernel *get(int oversample, int quality, double cutoff, bool minimumPhase = false);
+
+private:
+    ResamplerKernel(int oversample, int quality, double cutoff, bool minimumPhase, int taps, const double *ir);
+};
+
+
+/**
+ * @brief Convert an impulse response to minimum phase with the same magnitude (homomorphic method)
+ * @param ir Impulse response, replaced in place
+ * @param len Number of taps
+ */
+void minimumPhaseIR(double *ir, int len);
+
+
+/**
+ * @brief Group delay at DC of an impulse response (centroid)
+ * @param ir Impulse response
+ * @param len Number of taps
+ * @return Delay in samples
+ */
+double groupDelay(const double *ir, int len);
+
+}
@@ -0,0 +1,342 @@
+/*                                                                     *\
+**       __   ___  ______                                              **
+**      / /  / _ \/_  __/                                              **
+**     / /__/ , _/ / /    Lindenberg                                   **
+**    /____/_/|_| /_/  Research Tec.                                   **
+**                                                                     **
+**                                                                     **
+**	  https://github.com/lindenbergresearch/LRTRack	                   **
+**    heapdump@icloud.com                                              **
+**		                                                               **
+**    Sound Modules for VCV Rack                                       **
+**    Copyright 2017-2019 by Patrick Lindenberg / LRT                  **
+**                                                                     **
+**    For Redistribution and use in source and binary forms,           **
+**    with or without modification please see LICENSE.                 **
+**                                                                     **
+\*                                                                     */
+#pragma once
+
+#include <cstring>
+#include "DiodeLadder.hpp"
+#include "SIMDResampler.hpp"
+
+namespace lrt {
+
+/**
+ * @brief One pole of the polyphonic ladder, same as DiodeLadderStage with one voice per lane
+ */
+template<typename T>
+struct SIMDDiodeLadderStage {
+    T alpha = 1.f, beta = -1.f, gamma = 1.f, delta = 0.f, epsilon = 1.f;
+    T gain = 1.f;
+    T feedback = 0.f;
+    T z1 = 0.f;
+
+
+    inline T tick(T in) {
+        T x = in * gamma + feedback + epsilon * getFeedbackOutput();
+        T vn = (gain * x - z1) * alpha;
+        T out = vn + z1;
+
+        z1 = vn + out;
+
+        return out;
+    }
+
+
+    inline void reset() {
+        z1 = 0.f;
+        feedback = 0.f;
+    }
+
+
+    inline T getFeedbackOutput() {
+        return (z1 + feedback * delta) * beta;
+    }
+};
+
+
+/**
+ * @brief Polyphonic version of DiodeLadderFilter, processes one voice per SIMD lane
+ *
+ * Every lane has its own cutoff, resonance and saturation. The cutoff coefficients are looked up
+ * per lane in the shared CutoffTable and ramped linear per lane between control rate updates,
+ * everything else including the oversampling runs on the whole vector.
+ *
+ * @tparam T Vector type, float4 or float8
+ */
+template<typename T>
+struct SIMDDiodeLadder : DSPEffect {
+    static const int LANES = T::SIZE;
+
+    SIMDDiodeLadderStage<T> lpf1, lpf2, lpf3, lpf4;
+    simd::NoiseV<T::SIZE> noise;
+
+    SIMDResampler<T> *rs;
+    SIMDResampler<T> *linear, *minimum;
+
+    /* shared cutoff tables for the host and the oversampled rate */
+    const CutoffTable *table, *tableOversampled;
+
+    bool low = false;
+
+    T fc = 0.f, k = 0.f, saturation = 1.f;
+    T in = 0.f, out = 0.f, out2 = 0.f;
+
+    /* warped cutoff g with its per lane ramp */
+    T g = 0.f, gTarget = 0.f, gStep = 0.f;
+    int gRemaining = 0;
+
+    T gamma = 0.f, satNorm = 1.f;
+    T sg1 = 0.f, sg2 = 0.f, sg3 = 0.f, sg4 = 1.f;
+
+
+    explicit SIMDDiodeLadder(float sr) : DSPEffect(sr) {
+        linear = new SIMDResampler<T>(OVERSAMPLE, 4);
+        minimum = new SIMDResampler<T>(OVERSAMPLE, 4, true);
+        rs = linear;
+
+        table = CutoffTable::get(1000.f, 0.f, sr);
+        tableOversampled = CutoffTable::get(1000.f, 0.f, sr * OVERSAMPLE);
+
+        lpf2.gain = 0.5f;
+        lpf3.gain = 0.5f;
+        lpf4.gain = 0.5f;
+
+        lpf4.gamma = 1.f;
+        lpf4.delta = 0.f;
+        lpf4.epsilon = 0.f;
+
+        satNorm = 1.f / simd::fastatan(saturation);
+    }
+
+
+    ~SIMDDiodeLadder() {
+        delete linear;
+        delete minimum;
+    }
+
+
+    SIMDDiodeLadder(const SIMDDiodeLadder &) = delete;
+    SIMDDiodeLadder &operator=(const SIMDDiodeLadder &) = delete;
+
+
+    void setSamplerate(float sr) override {
+        table = CutoffTable::get(1000.f, 0.f, sr);
+        tableOversampled = CutoffTable::get(1000.f, 0.f, sr * OVERSAMPLE);
+
+        DSPEffect::setSamplerate(sr);
+    }
+
+
+    /**
+     * @brief Look up the cutoff of every lane and start the ramp towards it
+     */
+    void invalidate() override {
+        const CutoffTable *t = low ? table : tableOversampled;
+        float target[LANES];
+
+        for (int i = 0; i < LANES; i++) {
+            target[i] = t->getG(fc[i]);
+        }
+
+        gTarget = T::load(target);
+
+        if (rampLength > 1) {
+            gStep = (gTarget - g) / (float) rampLength;
+            gRemaining = rampLength;
+        } else {
+            g = gTarget;
+            gRemaining = 0;
+        }
+
+        setCoefficients(g);
+    }
+
+
+    /**
+     * @brief Same as DiodeLadderFilter::setCoefficients() for all lanes
+     * @param g Warped cutoff per lane
+     */
+    void setCoefficients(T g) {
+        T G4 = 0.5f * g / (1.0f + g);
+        T G3 = 0.5f * g / (1.0f + g - 0.5f * g * G4);
+        T G2 = 0.5f * g / (1.0f + g - 0.5f * g * G3);
+        T G1 = g / (1.0f + g - g * G2);
+
+        gamma = G4 * G3 * G2 * G1;
+
+        sg1 = G4 * G3 * G2;
+        sg2 = G4 * G3;
+        sg3 = G4;
+
+        T alpha = g / (1.0f + g);
+
+        lpf1.alpha = alpha;
+        lpf2.alpha = alpha;
+        lpf3.alpha = alpha;
+        lpf4.alpha = alpha;
+
+        lpf1.beta = 1.0f / (1.0f + g - g * G2);
+        lpf2.beta = 1.0f / (1.0f + g - 0.5f * g * G3);
+        lpf3.beta = 1.0f / (1.0f + g - 0.5f * g * G4);
+        lpf4.beta = 1.0f / (1.0f + g);
+
+        lpf1.gamma = 1.0f + G1 * G2;
+        lpf2.gamma = 1.0f + G2 * G3;
+        lpf3.gamma = 1.0f + G3 * G4;
+
+        lpf1.delta = g;
+        lpf2.delta = 0.5f * g;
+        lpf3.delta = 0.5f * g;
+
+        lpf1.epsilon = G2;
+        lpf2.epsilon = G3;
+        lpf3.epsilon = G4;
+    }
+
+
+    /**
+     * @brief Process one sample of all lanes
+     */
+    void process() override {
+        update();
+
+        if (gRemaining > 0) {
+            g = --gRemaining == 0 ? gTarget : g + gStep;
+            setCoefficients(g);
+        }
+
+        if (low) {
+            process1();
+            return;
+        }
+
+        rs->doUpsample(in);
+        T *up = rs->getUpsampled();
+
+        for (int i = 0; i < rs->getFactor(); i++) {
+            in = up[i];
+            process1();
+            rs->data[i] = out;
+        }
+
+        out = rs->getDownsampled();
+    }
+
+
+    /**
+     * @brief One step of the ladder at the internal rate
+     */
+    inline void process1() {
+        lpf3.feedback = lpf4.getFeedbackOutput();
+        lpf2.feedback = lpf3.getFeedbackOutput();
+        lpf1.feedback = lpf2.getFeedbackOutput();
+
+        T sigma = sg1 * lpf1.getFeedbackOutput() +
+                  sg2 * lpf2.getFeedbackOutput() +
+                  sg3 * lpf3.getFeedbackOutput() +
+                  sg4 * lpf4.getFeedbackOutput();
+
+        T y = satNorm * simd::fastatan(saturation * in);
+
+        y += noise.getNext(DiodeLadderFilter::NOISE_GAIN);
+
+        T u = (y - k * sigma) / (1.f + k * gamma);
+
+        u = simd::fastatan(u / (float) FEEDBACK_LIMITER_GAIN) * (float) FEEDBACK_LIMITER_GAIN; // limit feedback gain of resonance
+
+        y = lpf1.tick(u);
+        y = lpf2.tick(y);
+        y = lpf3.tick(y);
+        y = lpf4.tick(y);
+
+        out2 = simd::fastTanh(u - y);
+        out = simd::fastTanh(y);
+    }
+
+
+    void setFrequency(T fc) {
+        if (memcmp(&this->fc, &fc, sizeof(T)) != 0) {
+            SIMDDiodeLadder::fc = fc;
+            markDirty();
+        }
+    }
+
+
+    void setResonance(T k) {
+        SIMDDiodeLadder::k = k;
+    }
+
+
+    void setSaturation(T saturation) {
+        if (memcmp(&this->saturation, &saturation, sizeof(T)) != 0) {
+            SIMDDiodeLadder::saturation = saturation;
+            satNorm = 1.f / simd::fastatan(saturation);
+        }
+    }
+
+
+    void setLow(bool low) {
+        if (SIMDDiodeLadder::low != low) {
+            SIMDDiodeLadder::low = low;
+            markDirty();
+        }
+    }
+
+
+    /**
+     * @brief Switch to the minimum phase resampler, which keeps the delay in feedback patches short
+     * @param lowLatency
+     */
+    void setLowLatency(bool lowLatency) {
+        SIMDResampler<T> *next = lowLatency ? minimum : linear;
+        if (next == rs) return;
+
+        /* start with clean histories, the other resampler is stale */
+        next->reset();
+        rs = next;
+    }
+
+
+    bool isLowLatency() const {
+        return rs == minimum;
+    }
+
+
+    void setIn(T in) {
+        SIMDDiodeLadder::in = in;
+    }
+
+
+    T getOut() const {
+        return out;
+    }
+
+
+    T getOut2() const {
+        return out2;
+    }
+
+
+    /**
+     * @brief No latency if oversampling is turned off
+     * @return
+     */
+    double getLatency() override {
+        if (low) return 0.;
+
+        return rs->getLatency();
+    }
+
+
+    void reset() {
+        lpf1.reset();
+        lpf2.reset();
+        lpf3.reset();
+        lpf4.reset();
+    }
+};
+
+}
@@ -0,0 +1,258 @@
+/*                                                                     *\
+**       __   ___  ______                                              **
+**      / /  / _ \/_  __/                                              **
+**     / /__/ , _/ / /    Lindenberg                                   **
+**    /____/_/|_| /_/  Research Tec.                                   **
+**                                                                     **
+**                                                                     **
+**	  https://github.com/lindenbergresearch/LRTRack	                   **
+**    heapdump@icloud.com                                              **
+**		                                                               **
+**    Sound Modules for VCV Rack                                       **
+**    Copyright 2017-2019 by Patrick Lindenberg / LRT                  **
+**                                                                     **
+**    For Redistribution and use in source and binary forms,           **
+**    with or without modification please see LICENSE.                 **
+**                                                                     **
+\*                                                                     */
+#pragma once
+
+#include <cstring>
+#include "LadderFilter.hpp"
+#include "CutoffTable.hpp"
+#include "SIMDResampler.hpp"
+
+namespace lrt {
+
+/**
+ * @brief Polyphonic version of LadderFilter, processes one voice per SIMD lane
+ *
+ * The pole states b0..b5 of every voice live in one vector each and all lanes share the kernel of
+ * one SIMDResampler. The slope fade is done with precomputed weights instead of branches, and the
+ * overload light is reduced once per host sample from the peak of the oversampled block.
+ *
+ * @tparam T Vector type, float4 or float8
+ */
+template<typename T>
+struct SIMDLadderFilter : DSPEffect {
+    static const int LANES = T::SIZE;
+    static const int OVERSAMPLE = LadderFilter::OVERSAMPLE;
+    static constexpr float LIGHT_DECAY = 0.99f * 0.99f * 0.99f * 0.99f;  // 0.99 per oversampled sample
+
+    SIMDResampler<T> *rs;
+    simd::NoiseV<T::SIZE> noise;
+
+    /* shared 20Hz * 1000^fc mapping at the oversampled rate */
+    const CutoffTable *table;
+
+    T b0 = 0.f, b1 = 0.f, b2 = 0.f, b3 = 0.f, b4 = 0.f, b5 = 0.f, bx = 0.f;
+    T p = 0.f, f = 0.f, q = 0.f;
+    T in = 0.f, lpOut = 0.f;
+
+    T frequency = 0.f, resExp = 0.f, drive = 0.f;
+    T driveGain = 1.f, outGain = 1.f;
+    T lightValue = 0.f;
+
+    /* normalized cutoff, ramped per lane like the ControlRamp of LadderFilter */
+    simd::ControlRampV<T::SIZE> freqRamp;
+
+    /* weights of the five poles for the current slope, see fade5() */
+    float slope = -1.f;
+    T w1 = 0.f, w2 = 0.f, w3 = 0.f, w4 = 0.f, w5 = 1.f;
+
+
+    explicit SIMDLadderFilter(float sr) : DSPEffect(sr) {
+        rs = new SIMDResampler<T>(OVERSAMPLE, 8);
+        table = CutoffTable::get(1000.f, 0.f, sr * OVERSAMPLE);
+
+        setDrive(0.f);
+        setSlope(0.f);
+    }
+
+
+    ~SIMDLadderFilter() {
+        delete rs;
+    }
+
+
+    SIMDLadderFilter(const SIMDLadderFilter &) = delete;
+    SIMDLadderFilter &operator=(const SIMDLadderFilter &) = delete;
+
+
+    void setSamplerate(float sr) override {
+        table = CutoffTable::get(1000.f, 0.f, sr * OVERSAMPLE);
+        DSPEffect::setSamplerate(sr);
+    }
+
+
+    /**
+     * @brief Look up the cutoff of every lane and start the ramp towards it
+     */
+    void invalidate() override {
+        float target[LANES];
+
+        for (int i = 0; i < LANES; i++) {
+            target[i] = clampf(table->getHz(frequency[i]) * (1.f / (sr * OVERSAMPLE / 2.f)), 0.f, 0.9f);
+        }
+
+        freqRamp.set(T::load(target), rampLength);
+        setCoefficients(freqRamp.value);
+    }
+
+
+    /**
+     * @brief Same as LadderFilter::setCoefficients() for all lanes
+     * @param freqExp Normalized cutoff per lane
+     */
+    void setCoefficients(T freqExp) {
+        T q0 = 1.0f - freqExp;
+
+        p = freqExp + 0.8f * freqExp * q0;
+        f = p + p - 1.0f;
+        q = resExp * (1.0f + 0.5f * q0 * (1.0f - q0 + 5.6f * q0 * q0));
+    }
+
+
+    /**
+     * @brief Compute one sample of all lanes at the oversampled rate
+     * @param x Input samples
+     * @param peak Running maximum of the overdrive level
+     * @return
+     */
+    inline T tick(T x, T &peak) {
+        // non linear feedback with nice saturation
+        x -= simd::fastatan(bx * q);
+
+        T t1 = b1;
+        b1 = (x + b0) * p - b1 * f;
+
+        T t2 = b2;
+        b2 = (b1 + t1) * p - b2 * f;
+
+        t1 = b3;
+        b3 = (b2 + t2) * p - b3 * f;
+
+        t2 = b4;
+        b4 = (b3 + t1) * p - b4 * f;
+
+        b5 = (b4 + t2) * p - b5 * f;
+
+        // fade over lpf poles from 3dB/oct (1P) => 48dB/oct (5P)
+        bx = w1 * b1 + w2 * b2 + w3 * b3 + w4 * b4 + w5 * b5;
+
+        // saturate and add very low noise to have self oscillation with no input and high res
+        b0 = simd::fastatan(x + noise.getNext(LadderFilter::NOISE_GAIN));
+
+        T y = bx * driveGain;
+        peak = simd::fmax(peak, simd::fabs(y));
+
+        return simd::fastatan(y);
+    }
+
+
+    /**
+     * @brief Process one sample of all lanes
+     */
+    void process() override {
+        update();
+
+        if (freqRamp.isRamping()) setCoefficients(freqRamp.next());
+
+        rs->doUpsample(in);
+
+        T *up = rs->getUpsampled();
+        T peak = 0.f;
+
+        for (int i = 0; i < OVERSAMPLE; i++) {
+            rs->data[i] = tick(up[i], peak);
+        }
+
+        lpOut = rs->getDownsampled() * outGain;
+
+        /* same as the per sample meter of LadderFilter, the decay is applied for the whole block */
+        lightValue = simd::ifelse(peak > 1.f, (lightValue + peak * 0.2f) * 0.5f, lightValue * LIGHT_DECAY);
+    }
+
+
+    void setFrequency(T frequency) {
+        if (memcmp(&this->frequency, &frequency, sizeof(T)) != 0) {
+            SIMDLadderFilter::frequency = frequency;
+            markDirty();
+        }
+    }
+
+
+    void setResonance(T resonance) {
+        resonance = simd::clampf(resonance, T(0.f), T(1.5f));
+
+        if (memcmp(&resExp, &resonance, sizeof(T)) != 0) {
+            resExp = resonance;
+            markDirty();
+        }
+    }
+
+
+    void setDrive(T drive) {
+        SIMDLadderFilter::drive = simd::clampf(drive, T(0.f), T(1.f));
+
+        T d3 = SIMDLadderFilter::drive * 3.f;
+
+        driveGain = 1.f + SIMDLadderFilter::drive * 40.f;
+        outGain = LadderFilter::INPUT_GAIN / (SIMDLadderFilter::drive * 20.f + 1.f) * (d3 * d3 + 1.f);
+    }
+
+
+    /**
+     * @brief Set the slope for all lanes, the pole weights are only recomputed on change
+     * @param slope 0..4
+     */
+    void setSlope(float slope) {
+        slope = clampf(slope, 0.f, 4.f);
+        if (slope == SIMDLadderFilter::slope) return;
+
+        SIMDLadderFilter::slope = slope;
+
+        float w[5] = {};
+
+        if (slope < 4.f) {
+            int i = (int) slope;
+
+            w[i] = 1.f - (slope - i);
+            w[i + 1] = slope - i;
+        } else {
+            w[4] = 1.f;
+        }
+
+        w1 = w[0];
+        w2 = w[1];
+        w3 = w[2];
+        w4 = w[3];
+        w5 = w[4];
+    }
+
+
+    /**
+     * @brief Set input of all lanes, scaled and limited the same way as LadderFilter::setIn()
+     * @param in
+     */
+    void setIn(T in) {
+        SIMDLadderFilter::in = simd::clampf(in * (1.f / LadderFilter::INPUT_GAIN), T(-0.8f), T(0.8f));
+    }
+
+
+    T getLpOut() const {
+        return lpOut;
+    }
+
+
+    T getLightValue() const {
+        return lightValue;
+    }
+
+
+    double getLatency() override {
+        return rs->getLatency();
+    }
+};
+
+}
@@ -0,0 +1,233 @@
+/*                                                                     *\
+**       __   ___  ______                                              **
+**      / /  / _ \/_  __/                                              **
+**     / /__/ , _/ / /    Lindenberg                                   **
+**    /____/_/|_| /_/  Research Tec.                                   **
+**                                                                     **
+**                                                                     **
+**	  https://github.com/lindenbergresearch/LRTRack	                   **
+**    heapdump@icloud.com                                              **
+**		                                                               **
+**    Sound Modules for VCV Rack                                       **
+**    Copyright 2017-2019 by Patrick Lindenberg / LRT                  **
+**                                                                     **
+**    For Redistribution and use in source and binary forms,           **
+**    with or without modification please see LICENSE.                 **
+**                                                                     **
+\*                                                                     */
+#pragma once
+
+#include <cstring>
+#include "MS20zdf.hpp"
+#include "CutoffTable.hpp"
+#include "SIMDResampler.hpp"
+
+namespace lrt {
+
+/**
+ * @brief Polyphonic version of MS20zdf, processes one voice per SIMD lane
+ *
+ * Both zero delay feedback stages and the implicit solve of the loop run on whole vectors, atanf
+ * is replaced by simd::atanf. Cutoff, peak and drive can differ per lane, the shaper type is
+ * shared by all lanes.
+ *
+ * @tparam T Vector type, float4 or float8
+ */
+template<typename T>
+struct SIMDMS20zdf : DSPEffect {
+    static const int LANES = T::SIZE;
+    static const int OVERSAMPLE = MS20zdf::OVERSAMPLE;
+
+    SIMDResampler<T> *rs;
+    SIMDResampler<T> *linear, *minimum;
+
+    /* shared cutoff table at the oversampled rate, 20Hz * 950^fc - 20Hz */
+    const CutoffTable *table;
+
+    /* integrator states of both stages and the feedback */
+    T s1 = 0.f, s2 = 0.f, ky = 0.f;
+
+    T frequency = -1.f, peak = -1.f;
+    T g = 0.f, g2 = 0.f, k = 0.f, gain = 1.f;
+    T in = 0.f, out = 0.f;
+    bool shaper = true;
+
+    /* warped cutoff g, ramped per lane like the ControlRamp of MS20zdf */
+    simd::ControlRampV<T::SIZE> gRamp;
+
+
+    explicit SIMDMS20zdf(float sr) : DSPEffect(sr) {
+        linear = new SIMDResampler<T>(OVERSAMPLE, 8);
+        minimum = new SIMDResampler<T>(OVERSAMPLE, 8, true);
+        rs = linear;
+
+        table = CutoffTable::get(950.f, -20.f, sr * OVERSAMPLE);
+
+        setFrequency(0.f);
+        setPeak(0.f);
+    }
+
+
+    ~SIMDMS20zdf() {
+        delete linear;
+        delete minimum;
+    }
+
+
+    SIMDMS20zdf(const SIMDMS20zdf &) = delete;
+    SIMDMS20zdf &operator=(const SIMDMS20zdf &) = delete;
+
+
+    void setSamplerate(float sr) override {
+        table = CutoffTable::get(950.f, -20.f, sr * OVERSAMPLE);
+        DSPEffect::setSamplerate(sr);
+    }
+
+
+    /**
+     * @brief Look up the cutoff of every lane and start the ramp towards it
+     */
+    void invalidate() override {
+        float target[LANES];
+
+        for (int i = 0; i < LANES; i++) {
+            target[i] = table->getGain(frequency[i]);
+        }
+
+        gRamp.set(T::load(target), rampLength);
+
+        g = gRamp.value;
+        g2 = g * g;
+    }
+
+
+    /**
+     * @brief Process one sample of all lanes
+     */
+    void process() override {
+        update();
+
+        if (gRamp.isRamping()) {
+            g = gRamp.next();
+            g2 = g * g;
+        }
+
+        rs->doUpsample(in);
+
+        T *up = rs->getUpsampled();
+
+        /* the denominator of the loop solution only changes with the coefficients */
+        T d = 1.f / (g2 * k - g * k + 1.f);
+
+        for (int i = 0; i < OVERSAMPLE; i++) {
+            T x = up[i];
+
+            /* first stage */
+            T u = x - ky;
+            T y1 = g * u + s1;
+            s1 += 2.f * g * (u - y1);
+
+            /* second stage */
+            u = y1 + ky;
+            T y2 = g * u + s2;
+            s2 += 2.f * g * (u - y2);
+
+            T y = d * (g2 * x + g * s1 + s2);
+
+            ky = k * simd::atanf(y * (1.f / 50.f)) * 50.f;
+
+            if (shaper) {
+                rs->data[i] = simd::fastatan(gain * y * (1.f / 6.f)) * 6.f;
+            } else {
+                rs->data[i] = simd::atanf(gain * y * (1.f / 6.f)) * 6.f;
+            }
+        }
+
+        out = rs->getDownsampled();
+    }
+
+
+    /**
+     * @brief Set cutoff of all lanes
+     * @param frequency 0..1.1
+     */
+    void setFrequency(T frequency) {
+        frequency = simd::clampf(frequency, T(0.f), T(1.1f));
+
+        if (memcmp(&this->frequency, &frequency, sizeof(T)) != 0) {
+            SIMDMS20zdf::frequency = frequency;
+            markDirty();
+        }
+    }
+
+
+    /**
+     * @brief Set peak of all lanes, shaped the same way as MS20zdf does
+     * @param peak 0..1.1
+     */
+    void setPeak(T peak) {
+        peak = simd::clampf(peak, T(0.f), T(1.1f));
+
+        if (memcmp(&this->peak, &peak, sizeof(T)) != 0) {
+            SIMDMS20zdf::peak = peak;
+
+            T p = peak - 1.f;
+            k = 2.f * (p * p * p + 1.f) * 1.0001f;
+        }
+    }
+
+
+    /**
+     * @brief Set drive of all lanes
+     * @param drive 0..1.1
+     */
+    void setDrive(T drive) {
+        drive = simd::clampf(drive, T(0.f), T(1.1f));
+        gain = drive * drive * MS20zdf::DRIVE_GAIN + 1.f;
+    }
+
+
+    /**
+     * @brief Select the output shaper for all lanes, see MS20zdf::setType()
+     * @param type
+     */
+    void setType(float type) {
+        shaper = type > 0;
+    }
+
+
+    /**
+     * @brief Switch to the minimum phase resampler, which keeps the delay in feedback patches short
+     * @param lowLatency
+     */
+    void setLowLatency(bool lowLatency) {
+        SIMDResampler<T> *next = lowLatency ? minimum : linear;
+        if (next == rs) return;
+
+        /* start with clean histories, the other resampler is stale */
+        next->reset();
+        rs = next;
+    }
+
+
+    bool isLowLatency() const {
+        return rs == minimum;
+    }
+
+
+    void setIn(T in) {
+        SIMDMS20zdf::in = in;
+    }
+
+
+    T getLPOut() const {
+        return out;
+    }
+
+
+    double getLatency() override {
+        return rs->getLatency();
+    }
+};
+
+}
@@ -0,0 +1,427 @@
+/*                                                                     *\
+**       __   ___  ______                                              **
+**      / /  / _ \/_  __/                                              **
+**     / /__/ , _/ / /    Lindenberg                                   **
+**    /____/_/|_| /_/  Research Tec.                                   **
+**                                                                     **
+**                                                                     **
+**	  https://github.com/lindenbergresearch/LRTRack	                   **
+**    heapdump@icloud.com                                              **
+**		                                                               **
+**    Sound Modules for VCV Rack                                       **
+**    Copyright 2017-2019 by Patrick Lindenberg / LRT                  **
+**                                                                     **
+**    For Redistribution and use in source and binary forms,           **
+**    with or without modification please see LICENSE.                 **
+**                                                                     **
+\*                                                                     */
+#pragma once
+
+#include <algorithm>
+#include "DSPMath.hpp"
+#include "DSPEffect.hpp"
+#include "DSPSimd.hpp"
+#include "Oscillator.hpp"
+
+namespace lrt {
+
+/**
+ * @brief Bank of oscillators like DSPBLOscillator, processes one voice per SIMD lane
+ *
+ * All voices are allocated up front, the state of every voice (phase, increment, integrators,
+ * drift LFO, detune) lives in one vector per group of lanes. Only the first setChannels() voices
+ * are computed, the waveforms are stored straight into the output buffers set in out[], e.g. the
+ * polyphonic voltages of a Rack port. Both waveform cores of DSPBLOscillator are available.
+ *
+ * @tparam T Vector type, float4 or float8
+ * @tparam VOICES Number of voices, a multiple of the lanes of T
+ */
+template<typename T, int VOICES = 16>
+struct SIMDOscillatorBank : DSPEffect {
+    static const int LANES = T::SIZE;
+    static const int GROUPS = VOICES / LANES;
+
+    enum Outputs {
+        SAW,
+        PULSE,
+        SINE,
+        TRI,
+        NOISE,
+        MIX,
+        NUM_OUTPUTS
+    };
+
+    /* output buffers with room for VOICES floats, nullptr skips the waveform */
+    float *out[NUM_OUTPUTS] = {};
+
+    int channels = 1;
+    int groups = 1;
+
+    DSPBLOscillator::Core core = DSPBLOscillator::INTEGRATED_BLIT;
+
+    /* per voice state */
+    T phase[GROUPS], incr[GROUPS];
+    T int1[GROUPS], int2[GROUPS], int3[GROUPS];
+    T detune[GROUPS], drift[GROUPS];
+    T lfoPhase[GROUPS], lfoFreq[GROUPS], lfoFrac[GROUPS];
+    T width[GROUPS];
+    T noiseOut[GROUPS];
+    simd::NoiseV<LANES> noise[GROUPS];
+
+    /* V/Oct and FM of every voice, 2^cv is only recomputed when the cv changes */
+    T cv[GROUPS], cvLast[GROUPS];
+    T base[GROUPS];
+    T fm[GROUPS];
+
+    /* phase increment = offset + shape(tune + fm) * scale, both ramped between control ticks */
+    T offset[GROUPS], offsetStep[GROUPS];
+    T scale[GROUPS], scaleStep[GROUPS];
+    float incrMin, incrMax;
+
+    /* warmup and control rate are shared by all voices */
+    float warmup, warmupTau;
+    int tick, controlTick;
+
+    /* shared knobs */
+    bool lfoMode = false, _lfoMode = false;
+    float tune = 0.f, oct = 0.f, _oct = 0.f, coeff = 1.f;
+
+    /* weights of SAW, PULSE, SINE and TRI in the mix */
+    float mix[4] = {};
+
+
+    explicit SIMDOscillatorBank(float sr) : DSPEffect(sr) {
+        reset();
+    }
+
+
+    /**
+     * @brief Reset all voices, every voice gets a new random detune and drift
+     */
+    void reset() {
+        Noise rnd;
+
+        warmupTau = sr * 1.5f;
+        tick = (int) round(sr * 0.7f);
+        warmup = 1 - fastExp2(-tick / warmupTau * (float) M_LOG2E);
+
+        /* the first sample starts the ramps */
+        controlTick = 0;
+
+        lfoMode = _lfoMode = false;
+        oct = _oct = 0.f;
+        coeff = 1.f;
+
+        for (int g = 0; g < GROUPS; g++) {
+            phase[g] = 0.f;
+            int1[g] = 0.f;
+            int2[g] = 0.f;
+            int3[g] = 0.f;
+            drift[g] = 0.f;
+            width[g] = PI;
+            noiseOut[g] = 0.f;
+            cv[g] = 0.f;
+            cvLast[g] = 0.f;
+            base[g] = 1.f;
+            fm[g] = 0.f;
+            noise[g] = simd::NoiseV<LANES>(22222u + 7919u * LANES * g);
+
+            for (int i = 0; i < LANES; i++) {
+                detune[g].set(i, rnd.getNext(DETUNE_AMOUNT));
+                lfoPhase[g].set(i, wrapTWOPI(rnd.getNext(TWOPI)));
+                lfoFreq[g].set(i, DRIFT_FREQ + rnd.getNext(DRIFT_VARIANZ));
+            }
+        }
+
+        invalidate();
+
+        for (int g = 0; g < GROUPS; g++) {
+            incr[g] = simd::clampf(offset[g], T(incrMin), T(incrMax));
+        }
+    }
+
+
+    /**
+     * @brief Recompute the drift LFO increments and jump to the pitch targets, e.g. on samplerate changes
+     */
+    void invalidate() override {
+        T all = T(1.f) > 0.f;
+
+        for (int g = 0; g < GROUPS; g++) {
+            /* the drift LFO is stepped once per control tick */
+            lfoFrac[g] = (TWOPI / (sr / DSPBLOscillator::CONTROL_RATE)) * lfoFreq[g];
+            updateTargets(g, all);
+        }
+    }
+
+
+    void setChannels(int channels) {
+        SIMDOscillatorBank::channels = std::max(1, std::min(channels, VOICES));
+        groups = (SIMDOscillatorBank::channels + LANES - 1) / LANES;
+    }
+
+
+    /**
+     * @brief Set the per voice and shared inputs, same ranges as DSPBLOscillator::setInputs()
+     * @param cv V/Oct of every voice (sum of both V/Oct inputs)
+     * @param fm FM of every voice
+     * @param pw Pulse width of every voice, 0..2
+     * @param tune Tune knob
+     * @param oct Octave knob, LFO_MODE switches to LFO mode
+     */
+    void setInputs(const float *cv, const float *fm, const float *pw, float tune, float oct) {
+        SIMDOscillatorBank::tune = tune;
+        SIMDOscillatorBank::oct = oct;
+        lfoMode = oct == LFO_MODE;
+
+        for (int g = 0; g < groups; g++) {
+            SIMDOscillatorBank::cv[g] = T::load(cv + g * LANES);
+            SIMDOscillatorBank::fm[g] = T::load(fm + g * LANES);
+            width[g] = T::load(pw + g * LANES) * PI;
+        }
+    }
+
+
+    /**
+     * @brief Set the level of each waveform in the MIX output
+     */
+    void setMix(float saw, float pulse, float sine, float tri) {
+        mix[0] = saw;
+        mix[1] = pulse;
+        mix[2] = sine;
+        mix[3] = tri;
+    }
+
+
+    void setCore(DSPBLOscillator::Core core) {
+        SIMDOscillatorBank::core = core;
+    }
+
+
+    bool isLFO() const {
+        return lfoMode;
+    }
+
+
+    float getFrequency(int voice) const {
+        return incr[voice / LANES][voice % LANES] * sr / TWOPI;
+    }
+
+
+    /**
+     * @brief BLIT generator of all lanes, see lrt::BLIT()
+     * @param N Harmonics
+     * @param phase Current phase of PLL
+     * @return
+     */
+    static inline T blit(T N, T phase) {
+        T a = simd::wrapTWOPI((simd::fmax(N - 1.f, T(0.f)) + 0.5f) * phase);
+        T x = (simd::fastSin(a) / simd::fastSin(0.5f * phase) - 1.f) * 2.f;
+
+        /* the division is undefined at phase 0, masked out here */
+        return simd::ifelse((phase > 0.f) | (phase < 0.f), x, T(1.f));
+    }
+
+
+    /**
+     * @brief Offset and scale of the phase increment of one group, see DSPBLOscillator::updateTargets()
+     * @param g
+     * @param jump Lanes which apply the targets at once, all others are left untouched. Without any lane
+     * set, every lane ramps towards its targets until the next control tick.
+     */
+    void updateTargets(int g, T jump) {
+        bool ramp = !simd::any(jump);
+        T changed = (cv[g] < cvLast[g]) | (cv[g] > cvLast[g]);
+
+        if (!ramp) changed = changed & jump;
+
+        /* the exponentials are only evaluated on changes */
+        if (simd::any(changed)) {
+            cvLast[g] = simd::ifelse(changed, cv[g], cvLast[g]);
+            base[g] = simd::ifelse(changed, simd::fastExp2(cv[g]), base[g]);
+        }
+
+        if (oct != _oct) {
+            _oct = oct;
+            coeff = fastExp2(oct);
+        }
+
+        _lfoMode = lfoMode;
+
+        float k = TWOPI / sr;
+
+        incrMin = 0.00001f * k;
+        incrMax = 18000.f * k;
+
+        T scaleTarget, offsetTarget;
+
+        if (lfoMode) {
+            scaleTarget = k;
+            offsetTarget = 0.f;
+        } else {
+            scaleTarget = base[g] * coeff * warmup * k;
+            offsetTarget = (DSPBLOscillator::NOTE_C4 + drift[g] + detune[g]) * scaleTarget;
+        }
+
+        if (ramp) {
+            offsetStep[g] = (offsetTarget - offset[g]) * (1.f / DSPBLOscillator::CONTROL_RATE);
+            scaleStep[g] = (scaleTarget - scale[g]) * (1.f / DSPBLOscillator::CONTROL_RATE);
+        } else {
+            offset[g] = simd::ifelse(jump, offsetTarget, offset[g]);
+            scale[g] = simd::ifelse(jump, scaleTarget, scale[g]);
+            offsetStep[g] = simd::ifelse(jump, T(0.f), offsetStep[g]);
+            scaleStep[g] = simd::ifelse(jump, T(0.f), scaleStep[g]);
+        }
+    }
+
+
+    /**
+     * @brief Pitch of all active groups, see DSPBLOscillator::updatePitch()
+     *
+     * V/Oct or octave changes beyond CV_EPSILON jump at once, drift and warmup are stepped once
+     * per control tick. Per sample only the ramps and the FM are computed.
+     */
+    void updatePitch() {
+        /* octave and mode are shared, a change hits every voice */
+        T moved = oct != _oct || lfoMode != _lfoMode ? T(1.f) > 0.f : T(0.f);
+
+        for (int g = 0; g < groups; g++) {
+            T jump = moved | (simd::fabs(cv[g] - cvLast[g]) > DSPBLOscillator::CV_EPSILON);
+            if (simd::any(jump)) updateTargets(g, jump);
+        }
+
+        if (--controlTick <= 0) {
+            controlTick = DSPBLOscillator::CONTROL_RATE;
+
+            // give it 30s to warmup
+            if (tick < sr * 30) {
+                tick += (tick < sr * 1.8f ? 7 : 1) * DSPBLOscillator::CONTROL_RATE; // accelerated detune
+                warmup = 1 - fastExp2(-tick / warmupTau * (float) M_LOG2E);
+            }
+
+            for (int g = 0; g < groups; g++) {
+                lfoPhase[g] = simd::wrapTWOPI(lfoPhase[g] + lfoFrac[g]);
+                drift[g] = simd::fastSin(lfoPhase[g]) * DRIFT_AMOUNT;
+
+                updateTargets(g, T(0.f));
+            }
+        }
+
+        /* convert knob value to unipolar */
+        float tuneLFO = pow2bpol((tune + 1) / 2) * LFO_SCALE;
+
+        for (int g = 0; g < groups; g++) {
+            offset[g] += offsetStep[g];
+            scale[g] += scaleStep[g];
+
+            T x;
+
+            if (lfoMode) {
+                x = tuneLFO + fm[g] * LFO_SCALE;
+            } else {
+                x = simd::pow2bpol((tune + fm[g]) * TUNE_SCALE);
+            }
+
+            incr[g] = simd::clampf(offset[g] + x * scale[g], T(incrMin), T(incrMax));
+        }
+    }
+
+
+    /**
+     * @brief SAW, PULSE and TRI of one group, see DSPBLOscillator::processBLIT()
+     */
+    inline void renderBLIT(int g, T &saw, T &pulse, T &tri) {
+        /* harmonics up to nyquist */
+        T n = simd::floor(PI / incr[g]);
+
+        /* get impulse train */
+        T blit1 = blit(n, phase[g]);
+        T blit2 = blit(n, simd::wrapTWOPI(width[g] + phase[g]));
+
+        /* feed integrators */
+        T leak = incr[g] * 0.25f;
+
+        int1[g] = (blit1 - int1[g]) * leak + int1[g];
+        int2[g] = (blit2 - int2[g]) * leak + int2[g];
+
+        T delta = int1[g] - int2[g];
+
+        int3[g] = (delta - int3[g]) * leak + int3[g];
+
+        saw = int1[g] * -2.5f;
+        pulse = delta * 2.f;
+        tri = int3[g] * (1.8f * 5.f);
+    }
+
+
+    /**
+     * @brief SAW, PULSE and TRI of one group, see DSPBLOscillator::processPolyBLEP()
+     */
+    inline void renderPolyBLEP(int g, T &saw, T &pulse, T &tri) {
+        /* normalized phase 0..1 and increment */
+        T t = phase[g] * (1.f / TWOPI);
+        t = simd::ifelse(t < 0.f, t + 1.f, t);
+
+        T dt = incr[g] * (1.f / TWOPI);
+
+        /* duty cycle and phase relative to the falling edge */
+        T d = 1.f - width[g] * (0.5f / PI);
+        T t2 = t - d;
+        t2 = simd::ifelse(t2 < 0.f, t2 + 1.f, t2);
+
+        T blep1 = simd::polyBLEP(t, dt);
+        T blep = blep1 - simd::polyBLEP(t2, dt);
+        T blamp = simd::polyBLAMP(t, dt) - simd::polyBLAMP(t2, dt);
+
+        T high = t < d;
+
+        saw = (t + t - 1.f - blep1) * (1.25f * PI);
+        pulse = (simd::ifelse(high, 1.f - d, -d) * 2.f + blep) * PI;
+
+        /* peak at the falling edge, the slope changes by 12 PI at both corners */
+        T ramp = simd::ifelse(high, t * (1.f - d), (1.f - t) * d);
+        tri = (ramp * 12.f - 6.f * d * (1.f - d) + 6.f * dt * blamp) * PI;
+    }
+
+
+    /**
+     * @brief Compute one sample of all active voices and store it to the output buffers
+     */
+    void process() override {
+        update();
+        updatePitch();
+
+        /* noise acts as S&H in LFO mode and is only updated once per cycle */
+        T hold = lfoMode ? T(0.f) : T(1.f);
+
+        for (int g = 0; g < groups; g++) {
+            /* phase locked loop */
+            phase[g] = simd::wrapTWOPI(incr[g] + phase[g]);
+
+            T saw, pulse, tri;
+
+            if (core == DSPBLOscillator::POLYBLEP) renderPolyBLEP(g, saw, pulse, tri);
+            else renderBLIT(g, saw, pulse, tri);
+
+            T sine = simd::fastSin(phase[g]) * 5.f;
+
+            T wrapped = (phase[g] - incr[g] <= (float) -M_PI) | (hold > 0.f);
+            noiseOut[g] = simd::ifelse(wrapped, noise[g].getNext(10.f) - 5.f, noiseOut[g]);
+
+            int offset = g * LANES;
+
+            if (out[SAW]) saw.store(out[SAW] + offset);
+            if (out[PULSE]) pulse.store(out[PULSE] + offset);
+            if (out[SINE]) sine.store(out[SINE] + offset);
+            if (out[TRI]) tri.store(out[TRI] + offset);
+            if (out[NOISE]) noiseOut[g].store(out[NOISE] + offset);
+
+            if (out[MIX]) {
+                T m = saw * mix[0] + pulse * mix[1] + sine * mix[2] + tri * mix[3];
+                m.store(out[MIX] + offset);
+            }
+        }
+    }
+};
+
+}
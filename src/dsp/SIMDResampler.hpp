@@ -0,0 +1,187 @@
+/*                                                                     *\
+**       __   ___  ______                                              **
+**      / /  / _ \/_  __/                                              **
+**     / /__/ , _/ / /    Lindenberg                                   **
+**    /____/_/|_| /_/  Research Tec.                                   **
+**                                                                     **
+**                                                                     **
+**	  https://github.com/lindenbergresearch/LRTRack	                   **
+**    heapdump@icloud.com                                              **
+**		                                                               **
+**    Sound Modules for VCV Rack                                       **
+**    Copyright 2017-2019 by Patrick Lindenberg / LRT                  **
+**                                                                     **
+**    For Redistribution and use in source and binary forms,           **
+**    with or without modification please see LICENSE.                 **
+**                                                                     **
+\*                                                                     */
+#pragma once
+
+#include "DSPEffect.hpp"
+#include "DSPSimd.hpp"
+
+namespace lrt {
+
+/**
+ * @brief Polyphonic oversampling class, processes one voice per SIMD lane
+ *
+ * All lanes share one kernel and the histories are stored interleaved (one vector per sample),
+ * so every tap is a single multiply-accumulate over all voices. Use float4 for 4 and float8 for
+ * 8 voices per instance.
+ *
+ * @tparam T Vector type, float4 or float8
+ */
+template<typename T>
+struct SIMDResampler {
+    static const int LANES = T::SIZE;
+
+    T *up;
+    T *data;
+
+    int oversample, quality;
+    double cutoff = 0.65;
+
+
+    /**
+     * @brief Constructor
+     * @param oversample Oversampling factor
+     * @param quality Kernel length per sample
+     * @param minimumPhase Use the minimum phase kernel
+     */
+    SIMDResampler(int oversample, int quality = 4, bool minimumPhase = false) {
+        SIMDResampler::oversample = oversample;
+        SIMDResampler::quality = quality;
+
+        auto k = ResamplerKernel::get(oversample, quality, cutoff, minimumPhase);
+
+        taps = k->taps;
+        length = k->length;
+        latency = (2. * k->delay - (oversample - 1)) / oversample;
+        phases = k->phasesf;
+        kernel = k->reversedf;
+
+        up = new T[oversample];
+        data = new T[oversample];
+        upBuffer = new T[2 * taps];
+        downBuffer = new T[2 * length];
+
+        reset();
+    }
+
+
+    ~SIMDResampler() {
+        delete[] up;
+        delete[] data;
+        delete[] upBuffer;
+        delete[] downBuffer;
+    }
+
+
+    SIMDResampler(const SIMDResampler &) = delete;
+    SIMDResampler &operator=(const SIMDResampler &) = delete;
+
+
+    void reset() {
+        upIndex = 0;
+        downIndex = 0;
+
+        for (int i = 0; i < oversample; i++) {
+            up[i] = T::zero();
+            data[i] = T::zero();
+        }
+
+        for (int i = 0; i < 2 * taps; i++) {
+            upBuffer[i] = T::zero();
+        }
+
+        for (int i = 0; i < 2 * length; i++) {
+            downBuffer[i] = T::zero();
+        }
+    }
+
+
+    int getFactor() {
+        return oversample;
+    }
+
+
+    /**
+     * @brief Group delay of the upsample -> downsample path in samples at the host rate
+     * @return
+     */
+    double getLatency() {
+        return latency;
+    }
+
+
+    /**
+     * @brief Create up-sampled data for all lanes
+     * @param in One input sample per lane
+     */
+    void doUpsample(T in) {
+        in = in * (float) (UPSAMPLE_COMPENSATION * oversample);
+
+        upBuffer[upIndex] = in;
+        upBuffer[upIndex + taps] = in;
+
+        if (++upIndex >= taps) upIndex = 0;
+
+        const T *x = &upBuffer[upIndex];
+
+        for (int i = 0; i < oversample; i++) {
+            const float *h = &phases[i * taps];
+            T y = T::zero();
+
+            for (int j = 0; j < taps; j++) {
+                y += x[j] * h[j];
+            }
+
+            up[i] = y;
+        }
+    }
+
+
+    /**
+     * @brief Upsampled data of all lanes
+     * @return Pointer to the upsampled data, length is the oversampling factor
+     */
+    T *getUpsampled() {
+        return up;
+    }
+
+
+    /**
+     * @brief Downsample the content of data[] for all lanes
+     * @return One output sample per lane
+     */
+    T getDownsampled() {
+        for (int i = 0; i < oversample; i++) {
+            downBuffer[downIndex + i] = data[i];
+            downBuffer[downIndex + length + i] = data[i];
+        }
+
+        downIndex += oversample;
+        if (downIndex >= length) downIndex = 0;
+
+        const T *x = &downBuffer[downIndex];
+        T y = T::zero();
+
+        for (int i = 0; i < length; i++) {
+            y += x[i] * kernel[i];
+        }
+
+        return y;
+    }
+
+
+private:
+    const float *phases;
+    const float *kernel;
+    T *upBuffer;
+    T *downBuffer;
+    int upIndex, downIndex;
+    int taps, length;
+    double latency;
+};
+
+}
@@ -0,0 +1,250 @@
+/*                                                                     *\
+**       __   ___  ______                                              **
+**      / /  / _ \/_  __/                                              **
+**     / /__/ , _/ / /    Lindenberg                                   **
+**    /____/_/|_| /_/  Research Tec.                                   **
+**                                                                     **
+**                                                                     **
+**	  https://github.com/lindenbergresearch/LRTRack	                   **
+**    heapdump@icloud.com                                              **
+**		                                                               **
+**    Sound Modules for VCV Rack                                       **
+**    Copyright 2017-2019 by Patrick Lindenberg / LRT                  **
+**                                                                     **
+**    For Redistribution and use in source and binary forms,           **
+**    with or without modification please see LICENSE.                 **
+**                                                                     **
+\*                                                                     */
+#pragma once
+
+#include <cstring>
+#include "DSPMath.hpp"
+#include "CutoffTable.hpp"
+#include "SIMDResampler.hpp"
+
+namespace lrt {
+
+/**
+ * @brief Moog 24 dB/oct resonant lowpass after Stilson/Smith, processes one voice per SIMD lane
+ *
+ * References: CSound source code, Stilson/Smith CCRMA paper, modified by paul.kellett@maxim.abel.co.uk
+ * July 2000, see http://musicdsp.org/showArchiveComment.php?ArchiveID=25
+ *
+ * Works on signals normalized to +/-1. Cutoff and resonance can differ per lane, the cutoff is
+ * mapped to 20Hz * 1000^fc and ramped per lane. Runs at 1x, 2x or 4x, both resamplers are
+ * allocated up front so the factor can be switched on the audio thread.
+ *
+ * @tparam T Vector type, float4 or float8
+ */
+template<typename T>
+struct SIMDStilsonFilter : DSPEffect {
+    static const int LANES = T::SIZE;
+
+    enum Tap {
+        LOWPASS,    // b4
+        HIGHPASS,   // in - b4
+        BANDPASS    // 3 * (b3 - b4)
+    };
+
+    SIMDResampler<T> *rs2, *rs4;
+    SIMDResampler<T> *rs = nullptr;
+    int oversample = 1;
+
+    /* only used for the Hz mapping, which does not depend on the rate */
+    const CutoffTable *table;
+
+    T b0 = 0.f, b1 = 0.f, b2 = 0.f, b3 = 0.f, b4 = 0.f;
+    T p = 0.f, f = 0.f, q = 0.f;
+
+    T frequency = -1.f, resonance = 0.f;
+    T in = 0.f, out = 0.f;
+
+    /* normalized cutoff, ramped per lane between control rate updates */
+    simd::ControlRampV<T::SIZE> freqRamp;
+
+    /* weights of the taps, the selected one is 1 */
+    Tap tap = LOWPASS;
+    T wLP = 1.f, wHP = 0.f, wBP = 0.f;
+
+
+    explicit SIMDStilsonFilter(float sr) : DSPEffect(sr) {
+        rs2 = new SIMDResampler<T>(2, 8);
+        rs4 = new SIMDResampler<T>(4, 8);
+
+        table = CutoffTable::get(1000.f, 0.f, sr);
+    }
+
+
+    ~SIMDStilsonFilter() {
+        delete rs2;
+        delete rs4;
+    }
+
+
+    SIMDStilsonFilter(const SIMDStilsonFilter &) = delete;
+    SIMDStilsonFilter &operator=(const SIMDStilsonFilter &) = delete;
+
+
+    void setSamplerate(float sr) override {
+        table = CutoffTable::get(1000.f, 0.f, sr);
+        DSPEffect::setSamplerate(sr);
+    }
+
+
+    /**
+     * @brief Normalize the cutoff of every lane to the internal rate and start the ramp towards it
+     */
+    void invalidate() override {
+        float target[LANES];
+
+        for (int i = 0; i < LANES; i++) {
+            target[i] = clampf(table->getHz(frequency[i]) * (1.f / (sr * oversample / 2.f)), 0.f, 1.f);
+        }
+
+        freqRamp.set(T::load(target), rampLength);
+        setCoefficients(freqRamp.value);
+    }
+
+
+    /**
+     * @brief Set coefficients given the normalized cutoff and the resonance of all lanes
+     * @param frequency
+     */
+    void setCoefficients(T frequency) {
+        T q0 = 1.0f - frequency;
+
+        p = frequency + 0.8f * frequency * q0;
+        f = p + p - 1.0f;
+        q = resonance * (1.0f + 0.5f * q0 * (1.0f - q0 + 5.6f * q0 * q0));
+    }
+
+
+    /**
+     * @brief Compute one sample of all lanes at the internal rate
+     * @param x Input sample
+     * @return Selected tap
+     */
+    inline T tick(T x) {
+        x -= q * b4;
+
+        T t1 = b1;
+        b1 = (x + b0) * p - b1 * f;
+
+        T t2 = b2;
+        b2 = (b1 + t1) * p - b2 * f;
+
+        t1 = b3;
+        b3 = (b2 + t2) * p - b3 * f;
+
+        b4 = (b3 + t1) * p - b4 * f;
+
+        b4 = b4 - b4 * b4 * b4 * 0.166666667f;
+        b0 = x;
+
+        return wLP * b4 + wHP * (x - b4) + wBP * 3.0f * (b3 - b4);
+    }
+
+
+    void process() override {
+        processBlock(&in, &out, 1);
+    }
+
+
+    /**
+     * @brief Process a block of all lanes
+     * @param in Input samples, normalized to +/-1
+     * @param out Samples of the selected tap
+     * @param frames Number of samples
+     */
+    void processBlock(const T *in, T *out, int frames) {
+        update();
+
+        for (int i = 0; i < frames; i++) {
+            if (freqRamp.isRamping()) setCoefficients(freqRamp.next());
+
+            if (oversample == 1) {
+                out[i] = tick(in[i]);
+                continue;
+            }
+
+            /* the resampler gains up by UPSAMPLE_COMPENSATION, the filter should see the same level at every factor */
+            rs->doUpsample(in[i] * (float) (1. / UPSAMPLE_COMPENSATION));
+            T *up = rs->getUpsampled();
+
+            for (int j = 0; j < oversample; j++) {
+                rs->data[j] = tick(up[j]);
+            }
+
+            out[i] = rs->getDownsampled();
+        }
+    }
+
+
+    void setFrequency(T frequency) {
+        if (memcmp(&this->frequency, &frequency, sizeof(T)) != 0) {
+            SIMDStilsonFilter::frequency = frequency;
+            markDirty();
+        }
+    }
+
+
+    void setResonance(T resonance) {
+        resonance = simd::clampf(resonance, T(-1.f), T(1.f));
+
+        if (memcmp(&this->resonance, &resonance, sizeof(T)) != 0) {
+            SIMDStilsonFilter::resonance = resonance;
+            markDirty();
+        }
+    }
+
+
+    /**
+     * @brief Select the internal rate, the coefficients are renormalized with the next update
+     * @param oversample 1, 2 or 4, any other factor runs at the host rate
+     */
+    void setOversample(int oversample) {
+        if (oversample != 2 && oversample != 4) oversample = 1;
+        if (oversample == SIMDStilsonFilter::oversample) return;
+
+        SIMDStilsonFilter::oversample = oversample;
+
+        rs = oversample == 4 ? rs4 : (oversample == 2 ? rs2 : nullptr);
+        if (rs) rs->reset();
+
+        /* jump to the new cutoff instead of ramping across rates */
+        invalidate();
+        freqRamp.jump(freqRamp.target);
+        setCoefficients(freqRamp.value);
+    }
+
+
+    int getOversample() const {
+        return oversample;
+    }
+
+
+    void setTap(Tap tap) {
+        SIMDStilsonFilter::tap = tap;
+
+        wLP = tap == LOWPASS ? 1.f : 0.f;
+        wHP = tap == HIGHPASS ? 1.f : 0.f;
+        wBP = tap == BANDPASS ? 1.f : 0.f;
+    }
+
+
+    void setIn(T in) {
+        SIMDStilsonFilter::in = in;
+    }
+
+
+    T getOut() const {
+        return out;
+    }
+
+
+    double getLatency() override {
+        return rs ? rs->getLatency() : 0.;
+    }
+};
+
+}
@@ -0,0 +1,361 @@
+/*                                                                     *\
+**       __   ___  ______                                              **
+**      / /  / _ \/_  __/                                              **
+**     / /__/ , _/ / /    Lindenberg                                   **
+**    /____/_/|_| /_/  Research Tec.                                   **
+**                                                                     **
+**                                                                     **
+**	  https://github.com/lindenbergresearch/LRTRack	                   **
+**    heapdump@icloud.com                                              **
+**		                                                               **
+**    Sound Modules for VCV Rack                                       **
+**    Copyright 2017-2019 by Patrick Lindenberg / LRT                  **
+**                                                                     **
+**    For Redistribution and use in source and binary forms,           **
+**    with or without modification please see LICENSE.                 **
+**                                                                     **
+\*                                                                     */
+#pragma once
+
+#include <cstring>
+#include "Type35Filter.hpp"
+#include "SIMDResampler.hpp"
+
+namespace lrt {
+
+/**
+ * @brief Routing of the two filters, same order as the modes of the Type35 module
+ */
+enum Type35Routing {
+    T35_SERIAL_HP_LP,   // highpass into lowpass
+    T35_LOWPASS,        // lowpass only
+    T35_PARALLEL,       // sum of lowpass and highpass
+    T35_HIGHPASS,       // highpass only
+    T35_SERIAL_LP_HP    // lowpass into highpass
+};
+
+
+/**
+ * @brief One Type35 filter for all lanes, runs at the oversampled rate of its owner
+ *
+ * Same structure as Type35Filter::processLPF() / processHPF(), but without own resampler.
+ * Cutoff, peak and saturation can differ per lane.
+ */
+template<typename T, Type35Filter::FilterType TYPE>
+struct SIMDType35Core {
+    static const int LANES = T::SIZE;
+
+    Type35FilterStage<LP_STAGE, T> lpf1, lpf2;
+    Type35FilterStage<HP_STAGE, T> hpf1, hpf2;
+    simd::NoiseV<T::SIZE> noise;
+
+    const CutoffTable *table;
+
+    T fc = 1.1f, peak = 0.f, sat = 0.f;
+    T k = 0.f, kInv = 1.f, Ga = 1.f;
+
+    /* warped cutoff g, ramped per lane like the ControlRamp of Type35Filter */
+    simd::ControlRampV<T::SIZE> gRamp;
+
+    bool dirty = true;
+
+
+    /**
+     * @brief The lowpass maps its cutoff to 20Hz * 950^fc - 20Hz, the highpass to 20Hz * 1000^fc
+     * @param sr Oversampled rate
+     */
+    void setSamplerate(float sr) {
+        table = TYPE == Type35Filter::LPF ? CutoffTable::get(950.f, -20.f, sr) : CutoffTable::get(1000.f, 0.f, sr);
+        dirty = true;
+    }
+
+
+    void setFrequency(T fc) {
+        if (memcmp(&this->fc, &fc, sizeof(T)) != 0) {
+            SIMDType35Core::fc = fc;
+            dirty = true;
+        }
+    }
+
+
+    void setPeak(T peak) {
+        if (memcmp(&this->peak, &peak, sizeof(T)) != 0) {
+            SIMDType35Core::peak = peak;
+            dirty = true;
+        }
+    }
+
+
+    /**
+     * @brief Look up the cutoff of every lane and start the ramp towards it
+     * @param rampLength Length of the ramp in host samples
+     */
+    void invalidate(int rampLength) {
+        float target[LANES];
+
+        for (int i = 0; i < LANES; i++) {
+            target[i] = table->getG(clampf(fc[i], 0.f, 1.1f));
+        }
+
+        T p = simd::clampf(peak, T(0.0001f), T(1.1f)) - 1.f;
+
+        k = (p * p * p + 1.f) * 2.f;
+        kInv = 1.f / k;
+
+        gRamp.set(T::load(target), rampLength);
+        setCoefficients(gRamp.value);
+        dirty = false;
+    }
+
+
+    /**
+     * @brief Same as Type35Filter::setCoefficients() for all lanes
+     * @param g Warped cutoff
+     */
+    void setCoefficients(T g) {
+        T G = g / (1.f + g);
+
+        if (TYPE == Type35Filter::HPF) {
+            lpf1.alpha = G;
+            hpf1.alpha = G;
+            hpf2.alpha = G;
+
+            hpf2.beta = -1.f * G / (1.f + g);
+            lpf1.beta = 1.f / (1.f + g);
+        } else {
+            lpf1.alpha = G;
+            lpf2.alpha = G;
+            hpf1.alpha = G;
+
+            lpf2.beta = (k - k * G) / (1.f + g);
+            hpf1.beta = -1.f / (1.f + g);
+        }
+
+        Ga = 1.f / (1.f - k * G + k * G * G);
+    }
+
+
+    /**
+     * @brief Advance the cutoff ramp by one sample at the host rate
+     */
+    inline void updateRamp() {
+        if (gRamp.isRamping()) setCoefficients(gRamp.next());
+    }
+
+
+    /**
+     * @brief Compute one sample at the oversampled rate
+     * @param in
+     * @return
+     */
+    inline T tick(T in) {
+        in += noise.getNext(Type35Filter::NOISE_GAIN);
+
+        if (TYPE == Type35Filter::LPF) {
+            T y1 = lpf1.tick(in);
+            T s35h = hpf1.getFeedback() + lpf2.getFeedback();
+
+            T u = simd::fastatan(sat * (Ga * (y1 + s35h)) * 0.1f) * 10.f;
+            T y = k * lpf2.tick(u);
+
+            hpf1.tick(y);
+
+            return y * kInv;
+        } else {
+            T y1 = hpf1.tick(in);
+            T s35h = hpf2.getFeedback() + lpf1.getFeedback();
+
+            T u = Ga * (y1 + s35h);
+            T y = k * simd::fastatan(sat * u * 0.1f) * 10.f;
+
+            lpf1.tick(hpf2.tick(y));
+
+            return y * kInv;
+        }
+    }
+};
+
+
+/**
+ * @brief Polyphonic Type35 with lowpass and highpass, processes one voice per SIMD lane
+ *
+ * The routing is a template parameter of the inner loop, so every mode gets its own loop without
+ * any branch per sample. Both filters run inside one oversampling pass, also in the serial modes.
+ *
+ * @tparam T Vector type, float4 or float8
+ */
+template<typename T>
+struct SIMDType35 : DSPEffect {
+    static const int OVERSAMPLE = Type35Filter::OVERSAMPLE;
+
+    /* the serial modes used to pass the resampler twice, keep the gain of the second pass */
+    static constexpr float JUNCTION_GAIN = (float) UPSAMPLE_COMPENSATION;
+
+    SIMDType35Core<T, Type35Filter::LPF> lpf;
+    SIMDType35Core<T, Type35Filter::HPF> hpf;
+    SIMDResampler<T> *rs;
+
+    Type35Routing routing = T35_LOWPASS;
+    T in = 0.f, out = 0.f;
+
+
+    explicit SIMDType35(float sr) : DSPEffect(sr) {
+        rs = new SIMDResampler<T>(OVERSAMPLE, 8);
+
+        lpf.setSamplerate(sr * OVERSAMPLE);
+        hpf.setSamplerate(sr * OVERSAMPLE);
+    }
+
+
+    ~SIMDType35() {
+        delete rs;
+    }
+
+
+    SIMDType35(const SIMDType35 &) = delete;
+    SIMDType35 &operator=(const SIMDType35 &) = delete;
+
+
+    void setSamplerate(float sr) override {
+        lpf.setSamplerate(sr * OVERSAMPLE);
+        hpf.setSamplerate(sr * OVERSAMPLE);
+
+        DSPEffect::setSamplerate(sr);
+    }
+
+
+    void invalidate() override {
+        if (lpf.dirty) lpf.invalidate(rampLength);
+        if (hpf.dirty) hpf.invalidate(rampLength);
+    }
+
+
+    void setLpFrequency(T fc) {
+        lpf.setFrequency(fc);
+        if (lpf.dirty) markDirty();
+    }
+
+
+    void setLpPeak(T peak) {
+        lpf.setPeak(peak);
+        if (lpf.dirty) markDirty();
+    }
+
+
+    void setHpFrequency(T fc) {
+        hpf.setFrequency(fc);
+        if (hpf.dirty) markDirty();
+    }
+
+
+    void setHpPeak(T peak) {
+        hpf.setPeak(peak);
+        if (hpf.dirty) markDirty();
+    }
+
+
+    void setSaturation(T sat) {
+        lpf.sat = sat;
+        hpf.sat = sat;
+    }
+
+
+    void setRouting(Type35Routing routing) {
+        SIMDType35::routing = routing;
+    }
+
+
+    void process() override {
+        processBlock(&in, &out, 1);
+    }
+
+
+    /**
+     * @brief Process a block of all lanes
+     *
+     * The routing is resolved by one switch per call and the sample loop of each mode is branch
+     * free. The module runs one frame per call, so there it is still one switch per sample.
+     * @param in Input samples
+     * @param out Output samples
+     * @param frames Number of samples
+     */
+    void processBlock(const T *in, T *out, int frames) {
+        update();
+
+        switch (routing) {
+            case T35_SERIAL_HP_LP:
+                run<T35_SERIAL_HP_LP>(in, out, frames);
+                break;
+            case T35_LOWPASS:
+                run<T35_LOWPASS>(in, out, frames);
+                break;
+            case T35_PARALLEL:
+                run<T35_PARALLEL>(in, out, frames);
+                break;
+            case T35_HIGHPASS:
+                run<T35_HIGHPASS>(in, out, frames);
+                break;
+            case T35_SERIAL_LP_HP:
+                run<T35_SERIAL_LP_HP>(in, out, frames);
+                break;
+        }
+    }
+
+
+    void setIn(T in) {
+        SIMDType35::in = in;
+    }
+
+
+    T getOut() const {
+        return out;
+    }
+
+
+    double getLatency() override {
+        return rs->getLatency();
+    }
+
+private:
+    template<Type35Routing MODE>
+    void run(const T *in, T *out, int frames) {
+        const bool useLP = MODE != T35_HIGHPASS;
+        const bool useHP = MODE != T35_LOWPASS;
+
+        for (int i = 0; i < frames; i++) {
+            if (useLP) lpf.updateRamp();
+            if (useHP) hpf.updateRamp();
+
+            rs->doUpsample(in[i]);
+            T *up = rs->getUpsampled();
+
+            for (int j = 0; j < OVERSAMPLE; j++) {
+                T x = up[j];
+
+                switch (MODE) {
+                    case T35_SERIAL_HP_LP:
+                        x = lpf.tick(hpf.tick(x) * JUNCTION_GAIN);
+                        break;
+                    case T35_LOWPASS:
+                        x = lpf.tick(x);
+                        break;
+                    case T35_PARALLEL:
+                        x = lpf.tick(x) + hpf.tick(x);
+                        break;
+                    case T35_HIGHPASS:
+                        x = hpf.tick(x);
+                        break;
+                    case T35_SERIAL_LP_HP:
+                        x = hpf.tick(lpf.tick(x) * JUNCTION_GAIN);
+                        break;
+                }
+
+                rs->data[j] = x;
+            }
+
+            out[i] = rs->getDownsampled();
+        }
+    }
+};
+
+}
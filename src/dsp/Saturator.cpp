@@ -5,8 +5,10 @@ using namespace lrt;
 
 Saturator::Saturator(float sr) : WaveShaper(sr) {
     init();
+    initAdaptive();
     noise = new Noise;
-    tanh1 = new HQTanh(sr, 4);
+    tanh1[OVERSAMPLED_STATE] = new HQTanh(sr, 4);
+    tanh1[DIRECT_STATE] = new HQTanh(sr, 4);
 }
 
 
@@ -32,10 +34,10 @@ double Saturator::compute(double x) {
 
     in *= SATURATOR_GAIN;
 
-    in = tanh1->next(in);
+    in = tanh1[state]->next(in);
 
     in *= 1 / SATURATOR_GAIN * 0.3;
-    if (blockDC) in = dc->filter(in);
+    if (blockDC) in = dc[state]->filter(in);
 
     out = in;
 
@@ -1,46 +1,12 @@
 #include "Serge.hpp"
-#include "LambertW.h"
 
 using namespace lrt;
 
-double SergeWFStage::compute(double x) {
-    double out;
-    double l, u, ln, fn, xn;
-
-    l = sign(x);
-    u = (SERGE_R1 * SERGE_IS) / (SERGE_ETA * SERGE_VT) * pow(M_E, (l * x) / (SERGE_ETA * SERGE_VT));
-    ln = lrt::LambertW<0>(u);
-
-    fn = SERGE_VT * SERGE_ETA * SERGE_ETA * SERGE_VT * (ln * (ln + 2)) - x * x / 2;
-
-    // Check for ill-conditioning
-    if (abs(x - xn1) < SERGE_THRESHOLD) {
-        // Compute Averaged Wavefolder Output
-        xn = 0.5 * (x + xn1);
-        u = (SERGE_R1 * SERGE_IS) / (SERGE_ETA * SERGE_VT) * pow(M_E, (l * xn) / (SERGE_VT * SERGE_ETA));
-        ln = lrt::LambertW<0>(u);
-        out = 2 * l * SERGE_ETA * SERGE_VT * ln - xn;
-    } else {
-        // Apply AA Form
-        out = (fn - fn1) / (x - xn1);
-    }
-
-    fn1 = fn;
-    xn1 = x;
-
-    return out;
-}
-
-
-SergeWFStage::SergeWFStage() {
-    fn1 = 0;
-    xn1 = 0;
-}
-
-
 SergeWavefolder::SergeWavefolder(float sr) : WaveShaper(sr) {
     init();
-    tanh1 = new HQTanh(sr, 1);
+    initAdaptive();
+    tanh1[OVERSAMPLED_STATE] = new HQTanh(sr, 1);
+    tanh1[DIRECT_STATE] = new HQTanh(sr, 1);
 }
 
 
@@ -54,6 +20,12 @@ void SergeWavefolder::process() {
 }
 
 
+void SergeWavefolder::resetState(int state) {
+    WaveShaper::resetState(state);
+    folds[state].reset();
+}
+
+
 double SergeWavefolder::compute(double x) {
     double out;
     double in = clampd(x, -SHAPER_MAX_VOLTS, SHAPER_MAX_VOLTS);
@@ -63,15 +35,10 @@ double SergeWavefolder::compute(double x) {
 
     in *= 0.07;
 
-    in = sg1.compute(in);
-    in = sg2.compute(in);
-    in = sg3.compute(in);
-    in = sg4.compute(in);
-    in = sg5.compute(in);
-    in = sg6.compute(in);
+    in = folds[state].tick(in);
 
-    in = tanh1->next(in) * 3.f;
-    if (blockDC) in = dc->filter(in);
+    in = tanh1[state]->next(in) * 3.f;
+    if (blockDC) in = dc[state]->filter(in);
 
     out = in * 10;
 
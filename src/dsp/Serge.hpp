@@ -2,6 +2,8 @@
 
 #include "WaveShaper.hpp"
 #include "HQTrig.hpp"
+#include "DSPStage.hpp"
+#include "LambertW.h"
 
 #define SERGE_R1 33e3
 #define SERGE_IS 2.52e-9
@@ -12,22 +14,56 @@
 
 namespace lrt {
 
-struct SergeWFStage {
+/**
+ * @brief One folding stage, antiderivative antialiased
+ */
+struct SergeWFStage : DSPStage<SergeWFStage> {
 private:
-    double fn1, xn1;
+    double fn1 = 0, xn1 = 0;
 
 public:
-    SergeWFStage();
-    double compute(double x);
+
+    inline double tick(double x) {
+        double out;
+        double l, u, ln, fn, xn;
+
+        l = sign(x);
+        u = (SERGE_R1 * SERGE_IS) / (SERGE_ETA * SERGE_VT) * pow(M_E, (l * x) / (SERGE_ETA * SERGE_VT));
+        ln = lrt::LambertW<0>(u);
+
+        fn = SERGE_VT * SERGE_ETA * SERGE_ETA * SERGE_VT * (ln * (ln + 2)) - x * x / 2;
+
+        // Check for ill-conditioning
+        if (abs(x - xn1) < SERGE_THRESHOLD) {
+            // Compute Averaged Wavefolder Output
+            xn = 0.5 * (x + xn1);
+            u = (SERGE_R1 * SERGE_IS) / (SERGE_ETA * SERGE_VT) * pow(M_E, (l * xn) / (SERGE_VT * SERGE_ETA));
+            ln = lrt::LambertW<0>(u);
+            out = 2 * l * SERGE_ETA * SERGE_VT * ln - xn;
+        } else {
+            // Apply AA Form
+            out = (fn - fn1) / (x - xn1);
+        }
+
+        fn1 = fn;
+        xn1 = x;
+
+        return out;
+    }
+
+
+    inline void reset() {
+        fn1 = 0;
+        xn1 = 0;
+    }
 };
 
 
 struct SergeWavefolder : WaveShaper {
 
 private:
-    SergeWFStage sg1, sg2, sg3, sg4, sg5, sg6;
+    StageRepeat<SergeWFStage, 6> folds[NUM_STATES];
     //   DCBlocker *dc = new DCBlocker(DCBLOCK_ALPHA);
-    HQTanh *tanh1;
     bool blockDC = false;
 
 
@@ -38,6 +74,8 @@ public:
     void process() override;
     double compute(double x) override;
 
+protected:
+    void resetState(int state) override;
 };
 
 
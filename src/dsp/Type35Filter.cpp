@@ -21,83 +21,23 @@
 #include "DSPMath.hpp"
 
 
-/**
- * @brief Construct a new Korg35 filter stage
- * @param sr SampleRate
- * @param type Lowpass / Highpass
- */
-lrt::Type35FilterStage::Type35FilterStage(float sr, FilterType type) : DSPEffect(sr) {
-    this->type = type;
-}
-
-
-/**
- * @brief Init stage
- */
-void lrt::Type35FilterStage::init() {
-    type = LP_STAGE;
-    alpha = 1.f;
-    beta = 1.f;
-    zn1 = 0;
-    fc = 0;
-}
-
-
-/**
- * @brief Recompute filter parameter
- */
-void lrt::Type35FilterStage::invalidate() {
-    // only process in dedicated mode
-    if (!dedicated) return;
-
-    float wd = TWOPI * fc;
-    float T = 1.f / sr;
-    float wa = (2.f / T) * tanf(wd * T / 2.f);
-    float g = wa * T / 2.f;
-
-    alpha = g / (1.f + g);
-}
-
-
-/**
- * @brief Update filter and compute next sample
- */
-void lrt::Type35FilterStage::process() {
-    // v(n)
-    float vn = (in - zn1) * alpha;
-
-    float lpf = vn + zn1;
-
-    zn1 = vn + lpf;
-
-    float hpf = in - lpf;
-
-    // switch lpf type
-    if (type == LP_STAGE) {
-        out = lpf;
-    } else {
-        out = hpf;
-    }
-
-}
-
-
 /**
  * @brief Init main filter
  */
 void lrt::Type35Filter::init() {
     fc = sr / 2.f;
     peak = 0.f;
+    k = 0.f;
 
 
 
     /* lowpass stages */
-    lpf1->init();
-    lpf2->init();
+    lpf1.reset();
+    lpf2.reset();
 
     /* highpass stages */
-    hpf1->init();
-    hpf2->init();
+    hpf1.reset();
+    hpf2.reset();
 }
 
 
@@ -105,45 +45,42 @@ void lrt::Type35Filter::init() {
  * @brief Recompute filter parameter
  */
 void lrt::Type35Filter::invalidate() {
-    float frqHz;
+    float f = clampf(fc, 0.f, 1.1f);
 
-    fc = clampf(fc, 0.f, 1.1f);
-    peak = clampf(peak, 0.0001, 1.1f);
+    k = cubicShape(clampf(peak, 0.0001, 1.1f)) * 2.f;
 
-    if (type == LPF)
-        frqHz = (MAX_FREQUENCY / 1000.f) * powf(950.f, fc) - 20.f;
-    else
-        frqHz = (MAX_FREQUENCY / 1000.f) * powf(1000.f, fc);
-
-    peak = cubicShape(peak) * 2.f + noise.getNext(10e-7);
+    gRamp.set(table->getG(f), rampLength);
+    setCoefficients(gRamp.value);
+}
 
-    float wd = TWOPI * frqHz;
-    float T = 1.f / sr;
-    float wa = (2.f / T) * tanf(wd * T / 2.f);
-    float g = wa * T / 2.f;
 
+/**
+ * @brief Derive the stage coefficients from the warped cutoff and the shaped peak
+ * @param g Warped cutoff
+ */
+void lrt::Type35Filter::setCoefficients(float g) {
     float G = g / (1.f + g);
 
 
     if (type == HPF) {
         /* HIGHPASS */
-        lpf1->alpha = G;
-        hpf1->alpha = G;
-        hpf2->alpha = G;
+        lpf1.alpha = G;
+        hpf1.alpha = G;
+        hpf2.alpha = G;
 
-        hpf2->beta = -1.f * G / (1.f + g);
-        lpf1->beta = 1.f / (1.f + g);
+        hpf2.beta = -1.f * G / (1.f + g);
+        lpf1.beta = 1.f / (1.f + g);
     } else {
         /* LOWPASS */
-        lpf1->alpha = G;
-        lpf2->alpha = G;
-        hpf1->alpha = G;
+        lpf1.alpha = G;
+        lpf2.alpha = G;
+        hpf1.alpha = G;
 
-        lpf2->beta = (peak - peak * G) / (1.f + g);
-        hpf1->beta = -1.f / (1.f + g);
+        lpf2.beta = (k - k * G) / (1.f + g);
+        hpf1.beta = -1.f / (1.f + g);
     }
 
-    Ga = 1.f / (1.f - peak * G + peak * G * G);
+    Ga = 1.f / (1.f - k * G + k * G * G);
 }
 
 
@@ -159,29 +96,23 @@ void lrt::Type35Filter::process() {
  * @brief Do the lowpass filtering and oversampling
  */
 void lrt::Type35Filter::processLPF() {
-    lpf1->in = in + noise.getNext(NOISE_GAIN);;
-    lpf1->process();
-    float y1 = lpf1->out;
+    float y1 = lpf1.tick(in + noise.getNext(NOISE_GAIN));
 
-    float s35h = hpf1->getFeedback() + lpf2->getFeedback();
+    float s35h = hpf1.getFeedback() + lpf2.getFeedback();
 
     float u = Ga * (y1 + s35h);
     //float y = peak * fastatan(sat * u * 0.1) * 10.f;
 
     u = fastatan(sat * u * 0.1) * 10.f;
 
-    lpf2->in = u;
-    lpf2->process();
+    float y = k * lpf2.tick(u);
 
-    float y = peak * lpf2->out;
 
+    hpf1.tick(y);
 
-    hpf1->in = y;
-    hpf1->process();
 
-
-    if (peak > 0) {
-        y *= 1.f / peak; // normalize
+    if (k > 0) {
+        y *= 1.f / k; // normalize
     }
 
     out = y;
@@ -192,23 +123,17 @@ void lrt::Type35Filter::processLPF() {
  * @brief Do the highpass filtering and oversampling
  */
 void lrt::Type35Filter::processHPF() {
-    hpf1->in = in + noise.getNext(NOISE_GAIN);
-    hpf1->process();
-    float y1 = hpf1->out;
+    float y1 = hpf1.tick(in + noise.getNext(NOISE_GAIN));
 
-    float s35h = hpf2->getFeedback() + lpf1->getFeedback();
+    float s35h = hpf2.getFeedback() + lpf1.getFeedback();
 
     float u = Ga * (y1 + s35h);
-    float y = peak * fastatan(sat * u * 0.1) * 10.f;
-
-    hpf2->in = y;
-    hpf2->process();
+    float y = k * fastatan(sat * u * 0.1) * 10.f;
 
-    lpf1->in = hpf2->out;
-    lpf1->process();
+    lpf1.tick(hpf2.tick(y));
 
-    if (peak > 0) {
-        y *= 1.f / peak; // normalize
+    if (k > 0) {
+        y *= 1.f / k; // normalize
     }
 
     out = y;
@@ -220,31 +145,82 @@ void lrt::Type35Filter::processHPF() {
  * @param sr SR
  */
 void lrt::Type35Filter::setSamplerate(float sr) {
+    table = getTable(sr * OVERSAMPLE);
     DSPEffect::setSamplerate(sr * OVERSAMPLE);
 
-    // derive samplerate change
-    lpf1->setSamplerate(sr * OVERSAMPLE);
-    lpf2->setSamplerate(sr * OVERSAMPLE);
-    hpf1->setSamplerate(sr * OVERSAMPLE);
-    hpf2->setSamplerate(sr * OVERSAMPLE);
-
     invalidate();
 }
 
 
+void lrt::Type35Filter::setFrequency(float fc) {
+    if (Type35Filter::fc != fc) {
+        Type35Filter::fc = fc;
+        markDirty();
+    }
+}
+
+
+void lrt::Type35Filter::setPeak(float peak) {
+    if (Type35Filter::peak != peak) {
+        Type35Filter::peak = peak;
+        markDirty();
+    }
+}
+
+
 /**
  * @brief Top function which handles the oversampling
  */
 void lrt::Type35Filter::process2() {
+    update();
+    updateRamp();
+
     rs->doUpsample(IN, in);
 
     for (int i = 0; i < rs->getFactor(); i++) {
         in = (float) rs->getUpsampled(IN)[i];
 
-        process();
+        type == LPF ? processLPF() : processHPF();
 
         rs->data[IN][i] = out;
     }
 
     out = (float) rs->getDownsampled(IN);;
 }
+
+
+/**
+ * @brief Block version of process2(), runs the whole block through the resampler at once
+ * @param in Input samples
+ * @param out Output samples
+ * @param frames Number of samples
+ */
+void lrt::Type35Filter::processBlock(const float *in, float *out, int frames) {
+    update();
+
+    float *os = rs->getBlockBuffer();
+    int factor = rs->getFactor();
+
+    while (frames > 0) {
+        int n = frames < RS_BLOCK_SIZE ? frames : RS_BLOCK_SIZE;
+
+        rs->upsampleBlock(IN, in, n, os);
+
+        for (int i = 0; i < n; i++) {
+            updateRamp();
+
+            for (int j = 0; j < factor; j++) {
+                Type35Filter::in = os[i * factor + j];
+                type == LPF ? processLPF() : processHPF();
+                os[i * factor + j] = Type35Filter::out;
+            }
+        }
+
+        rs->decimateBlock(IN, os, n, out);
+        Type35Filter::out = out[n - 1];
+
+        in += n;
+        out += n;
+        frames -= n;
+    }
+}
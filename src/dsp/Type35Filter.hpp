@@ -21,39 +21,52 @@
 
 #include "DSPEffect.hpp"
 #include "DSPMath.hpp"
+#include "DSPStage.hpp"
+#include "CutoffTable.hpp"
 
 namespace lrt {
 
+enum Type35StageType {
+    LP_STAGE,   // lowpass stage
+    HP_STAGE    // highpass stage
+};
+
+
 /**
- * @brief Represents one filter stage
+ * @brief Represents one filter stage, the type is fixed at compile time and the stage is embedded by value
+ * @tparam T float, or a SIMD vector for the polyphonic engine
  */
-struct Type35FilterStage : DSPEffect {
-    enum FilterType {
-        LP_STAGE,   // lowpass stage
-        HP_STAGE    // highpass stage
-    };
+template<Type35StageType TYPE, typename T = float>
+struct Type35FilterStage : DSPStage<Type35FilterStage<TYPE, T>> {
+    T alpha = 1.f, beta = 1.f;
+    T zn1 = 0.f;
 
-    bool dedicated = false;
+    T out = 0.f;
 
-    FilterType type;
 
-    float fc;
-    float alpha, beta;
-    float zn1;
+    inline T getFeedback() {
+        return zn1 * beta;
+    }
 
-    float in, out;
 
-    Type35FilterStage(float sr, FilterType type);
+    inline T tick(T in) {
+        // v(n)
+        T vn = (in - zn1) * alpha;
 
+        T lpf = vn + zn1;
 
-    inline float getFeedback() {
-        return zn1 * beta;
+        zn1 = vn + lpf;
+
+        // switch lpf type
+        out = TYPE == LP_STAGE ? lpf : in - lpf;
+
+        return out;
     }
 
 
-    void init() override;
-    void invalidate() override;
-    void process() override;
+    inline void reset() {
+        zn1 = 0.f;
+    }
 };
 
 
@@ -72,7 +85,8 @@ struct Type35Filter : DSPEffect {
     };
 
 
-    Type35FilterStage *lpf1, *lpf2, *hpf1, *hpf2;
+    Type35FilterStage<LP_STAGE> lpf1, lpf2;
+    Type35FilterStage<HP_STAGE> hpf1, hpf2;
     FilterType type;
     Noise noise;
     Resampler<1> *rs;
@@ -81,29 +95,65 @@ struct Type35Filter : DSPEffect {
 
     float in, out;
 
-    // cutofffrq, peak (resonance) and saturation level
+    // cutofffrq, peak (resonance) and saturation level, use the setters for fc and peak
     float fc, peak, sat;
 
+    // shaped peak, computed by invalidate()
+    float k;
+
+    // warped cutoff g, ramped per sample between control rate updates
+    ControlRamp gRamp{ControlRamp::EXPONENTIAL};
+
+    // shared cutoff table at the oversampled rate
+    const CutoffTable *table;
+
 
     Type35Filter(float sr, FilterType type) : DSPEffect(sr * OVERSAMPLE) {
         Type35Filter::type = type;
 
         rs = new Resampler<1>(OVERSAMPLE, 8);
-
-        lpf1 = new Type35FilterStage(sr * OVERSAMPLE, Type35FilterStage::LP_STAGE);
-        lpf2 = new Type35FilterStage(sr * OVERSAMPLE, Type35FilterStage::LP_STAGE);
-        hpf1 = new Type35FilterStage(sr * OVERSAMPLE, Type35FilterStage::HP_STAGE);
-        hpf2 = new Type35FilterStage(sr * OVERSAMPLE, Type35FilterStage::HP_STAGE);
+        table = getTable(DSPEffect::sr);
     }
 
 
     void init() override;
     void invalidate() override;
+    void setCoefficients(float g);
     void process() override;
     void process2();
+    void processBlock(const float *in, float *out, int frames);
+    void setFrequency(float fc);
+    void setPeak(float peak);
     void processLPF();
     void processHPF();
     void setSamplerate(float sr) override;
+
+
+    /**
+     * @brief The lowpass maps its cutoff to 20Hz * 950^fc - 20Hz, the highpass to 20Hz * 1000^fc
+     * @param sr Oversampled rate
+     * @return
+     */
+    const CutoffTable *getTable(float sr) const {
+        return type == LPF ? CutoffTable::get(950.f, -20.f, sr) : CutoffTable::get(1000.f, 0.f, sr);
+    }
+
+
+    /**
+     * @brief Advance the cutoff ramp by one sample at the host rate
+     */
+    inline void updateRamp() {
+        if (gRamp.isRamping()) setCoefficients(gRamp.next());
+    }
+
+
+    /**
+     * @brief The filter runs at the oversampled rate internally, so the latency is taken from the resampler
+     * @return
+     */
+    double getLatency() override {
+        return rs->getLatency();
+    }
 };
 
 }
@@ -67,6 +67,11 @@ void WaveShaper::process() {
         return;
     }
 
+    if (adaptiveActive) {
+        processAdaptive();
+        return;
+    }
+
     rs->doUpsample(STD_CHANNEL, beforeComputation(in));
 
     for (int i = 0; i < rs->getFactor(); i++) {
@@ -78,9 +83,144 @@ void WaveShaper::process() {
 }
 
 
+void WaveShaper::processBlock(const float *in, float *out, int frames) {
+    if (frames <= 0) return;
+
+    /* if no oversampling set up */
+    if (rs->getFactor() == 1) {
+        for (int i = 0; i < frames; i++) {
+            out[i] = (float) compute(in[i]);
+        }
+
+        WaveShaper::out = out[frames - 1];
+        return;
+    }
+
+    /* the adaptive path switches per sample, so run it sample by sample */
+    if (adaptiveActive) {
+        for (int i = 0; i < frames; i++) {
+            WaveShaper::in = in[i];
+            processAdaptive();
+            out[i] = (float) WaveShaper::out;
+        }
+
+        return;
+    }
+
+    float *os = rs->getBlockBuffer();
+
+    while (frames > 0) {
+        int n = frames < RS_BLOCK_SIZE ? frames : RS_BLOCK_SIZE;
+
+        for (int i = 0; i < n; i++) {
+            out[i] = (float) beforeComputation(in[i]);
+        }
+
+        rs->upsampleBlock(STD_CHANNEL, out, n, os);
+
+        for (int i = 0; i < n * rs->getFactor(); i++) {
+            os[i] = (float) compute(os[i]);
+        }
+
+        rs->decimateBlock(STD_CHANNEL, os, n, out);
+
+        for (int i = 0; i < n; i++) {
+            out[i] = (float) afterComputation(out[i]);
+        }
+
+        in += n;
+        out += n;
+        frames -= n;
+    }
+
+    WaveShaper::out = out[-1];
+}
+
+
+void WaveShaper::processAdaptive() {
+    double x = beforeComputation(in);
+    double y = 0.;
+
+    adaptive->analyze(x);
+
+    if (adaptive->isDecisionPending() && adaptive->decide(needsOversampling())) {
+        /* warm up the resampler with the recent input, so it fades in without a transient */
+        for (int i = adaptive->warmup; i > 0; i--) {
+            processOversampled(adaptive->getHistory(i));
+        }
+    }
+
+    /* direct path input, delayed to stay in line with the resampler */
+    double xd = adaptive->delay(x);
+
+    if (adaptive->isOversampled()) {
+        y = adaptive->mix * processOversampled(x);
+    }
+
+    /* the upsampler applies UPSAMPLE_COMPENSATION, so drive the direct path the same way */
+    if (adaptive->isDirect()) {
+        state = DIRECT_STATE;
+
+        /* the state of the direct path is stale after it was faded out, rebuild it from its recent input */
+        if (adaptive->isDirectStarting()) {
+            resetState(DIRECT_STATE);
+
+            for (int i = adaptive->latency + 2; i > 0; i--) {
+                compute(adaptive->getDirectHistory(i) * UPSAMPLE_COMPENSATION);
+            }
+        }
+
+        y += (1. - adaptive->mix) * compute(xd * UPSAMPLE_COMPENSATION);
+        state = OVERSAMPLED_STATE;
+    }
+
+    adaptive->next();
+
+    out = afterComputation(y);
+}
+
+
+double WaveShaper::processOversampled(double x) {
+    rs->doUpsample(STD_CHANNEL, x);
+
+    for (int i = 0; i < rs->getFactor(); i++) {
+        double xo = rs->getUpsampled(STD_CHANNEL)[i];
+        rs->data[STD_CHANNEL][i] = compute(xo);
+    }
+
+    return rs->getDownsampled(STD_CHANNEL);
+}
+
+
+bool WaveShaper::needsOversampling() {
+    double drive = (adaptive->peak * clampd(gain, 0., 20.) + fabs(bias * 2.)) / SHAPER_MAX_VOLTS;
+
+    return adaptive->isAliasing(drive);
+}
+
+
 WaveShaper::WaveShaper(float sr) : DSPEffect(sr) {}
 
 
+WaveShaper::~WaveShaper() {
+    for (int i = 0; i < NUM_STATES; i++) {
+        delete dc[i];
+        delete tanh1[i];
+    }
+
+    delete adaptive;
+    delete rs;
+}
+
+
+void WaveShaper::resetState(int state) {
+    dc[state]->xm1 = 0.;
+    dc[state]->ym1 = 0.;
+
+    if (tanh1[state] != nullptr) tanh1[state]->reset();
+}
+
+
 bool WaveShaper::isBlockDC() const {
     return blockDC;
 }
@@ -91,6 +231,40 @@ void WaveShaper::setBlockDC(bool blockDC) {
 }
 
 
+void WaveShaper::initAdaptive() {
+    if (adaptive == nullptr && rs->getFactor() > 1) adaptive = new AdaptiveOversampling(rs);
+}
+
+
+void WaveShaper::setAdaptive(bool adaptive) {
+    /* stays off without oversampling */
+    adaptive = adaptive && WaveShaper::adaptive != nullptr;
+
+    if (adaptive == adaptiveActive) return;
+
+    adaptiveActive = adaptive;
+
+    if (adaptive) {
+        WaveShaper::adaptive->reset();
+    } else {
+        /* the resampler may hold stale data from the last oversampled block */
+        rs->reset();
+    }
+}
+
+
+bool WaveShaper::isAdaptive() const {
+    return adaptiveActive;
+}
+
+
+int WaveShaper::getActiveFactor() {
+    if (adaptiveActive) return adaptive->getFactor();
+
+    return rs->getFactor();
+}
+
+
 
 
 
@@ -19,10 +19,22 @@ struct WaveShaper : DSPEffect {
     static constexpr double SHAPER_MAX_BIAS = 12.0; // +/- 5V
 
 protected:
-    Resampler<1> *rs;
-
-    DCBlocker *dc = new DCBlocker(DCBLOCK_ALPHA);
-    HQTanh *tanh1;
+    /* state sets of compute(), the direct path of the adaptive oversampling keeps its own */
+    enum ComputeState {
+        OVERSAMPLED_STATE,
+        DIRECT_STATE,
+        NUM_STATES
+    };
+
+    Resampler<1> *rs = nullptr;
+    AdaptiveOversampling *adaptive = nullptr;
+    bool adaptiveActive = false;
+
+    /* state set used by the current compute() call */
+    int state = OVERSAMPLED_STATE;
+
+    DCBlocker *dc[NUM_STATES] = {new DCBlocker(DCBLOCK_ALPHA), new DCBlocker(DCBLOCK_ALPHA)};
+    HQTanh *tanh1[NUM_STATES] = {};
     bool blockDC = false;
 
     double in, gain, bias, k;
@@ -32,6 +44,11 @@ protected:
 public:
 
     WaveShaper(float sr);
+    ~WaveShaper();
+
+    WaveShaper(const WaveShaper &) = delete;
+    WaveShaper &operator=(const WaveShaper &) = delete;
+
 
     double getIn() const;
     void setIn(double in);
@@ -54,6 +71,17 @@ public:
     }
 
 
+    /**
+     * @brief Group delay of the oversampling, zero if the shaper runs at the host rate
+     * @return
+     */
+    double getLatency() override {
+        if (rs->getFactor() == 1) return 0.;
+
+        return rs->getLatency();
+    }
+
+
     void setAmplitude(double kpos, double kneg) {
         amp = Pair(kpos, kneg);
     }
@@ -64,12 +92,38 @@ public:
     bool isBlockDC() const;
     void setBlockDC(bool blockDC);
 
+
+    /**
+     * @brief Enable adaptive oversampling, the factor is then chosen per block from gain, bias and
+     * the input signal. Has no effect on shapers without oversampling. Only switches a flag, so it
+     * could be called from the audio thread.
+     * @param adaptive
+     */
+    void setAdaptive(bool adaptive);
+    bool isAdaptive() const;
+
+
+    /**
+     * @brief Returns the oversampling factor currently in use, for metering
+     * @return
+     */
+    int getActiveFactor();
+
     /**
      * @brief Implements the oversamping of compute method
      */
     void process() override;
 
 
+    /**
+     * @brief Block version of process(), runs the whole block through the resampler at once
+     * @param in Input samples
+     * @param out Output samples
+     * @param frames Number of samples
+     */
+    void processBlock(const float *in, float *out, int frames);
+
+
     void init() override {
         gain = 0;
         out = 0;
@@ -104,6 +158,33 @@ public:
      * @return Output sample
      */
     virtual double afterComputation(double x) { return x; }
+
+
+    /**
+     * @brief Decision for adaptive oversampling, called with the peak and slope of the current block
+     * available in `adaptive`. The default estimates the drive from gain and bias.
+     *
+     * @return True if the block needs oversampling
+     */
+    virtual bool needsOversampling();
+
+protected:
+    /**
+     * @brief Clear a state set of compute(), shapers with stateful stages of their own extend it
+     * @param state OVERSAMPLED_STATE or DIRECT_STATE
+     */
+    virtual void resetState(int state);
+
+
+    /**
+     * @brief Allocate the adaptive oversampling state, to be called by the constructor of the subclass
+     * once the resampler is set up
+     */
+    void initAdaptive();
+
+private:
+    void processAdaptive();
+    double processOversampled(double x);
 };
 
 
@@ -1,4 +1,5 @@
 #include "../dsp/LadderFilter.hpp"
+#include "../dsp/SIMDLadderFilter.hpp"
 #include "../LindenbergResearch.hpp"
 #include "../LRModel.hpp"
 
@@ -6,6 +7,8 @@
 using namespace rack;
 using namespace lrt;
 
+using lrt::SIMDLadderFilter;
+
 struct AlmaFilterWidget;
 
 
@@ -40,9 +43,14 @@ struct AlmaFilter : LRModule {
         NUM_LIGHTS
     };
 
+    static const int CONTROL_RATE = 16;
+    static const int MAX_VOICES = 16;
+    static const int GROUPS = MAX_VOICES / float4::SIZE;
+
     AlmaFilterWidget *reflect;
 
-    lrt::LadderFilter *filter = new lrt::LadderFilter(APP->engine->getSampleRate());
+    /* one engine per 4 voices, allocated up front so nothing is created on the audio thread */
+    SIMDLadderFilter<float4> *filter[GROUPS];
 
 
     AlmaFilter() : LRModule(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS) {
@@ -55,7 +63,23 @@ struct AlmaFilter : LRModule {
         configParam(DRIVE_CV_PARAM, -1.f, 1.f, 0.f);
         configParam(SLOPE_PARAM, 0.0f, 4.f, 2.0f);
 
+        setControlRate(CONTROL_RATE);
+
+        for (int i = 0; i < GROUPS; i++) {
+            filter[i] = new SIMDLadderFilter<float4>(APP->engine->getSampleRate());
+        }
+    }
+
+
+    ~AlmaFilter() {
+        for (int i = 0; i < GROUPS; i++) {
+            delete filter[i];
+        }
+    }
+
 
+    double getLatency() override {
+        return filter[0]->getLatency();
     }
 
 
@@ -66,7 +90,10 @@ struct AlmaFilter : LRModule {
 
 void AlmaFilter::onSampleRateChange() {
     Module::onSampleRateChange();
-    filter->setSamplerate(APP->engine->getSampleRate());
+
+    for (int i = 0; i < GROUPS; i++) {
+        filter[i]->setSamplerate(APP->engine->getSampleRate());
+    }
 }
 
 
@@ -139,34 +166,64 @@ AlmaFilterWidget::AlmaFilterWidget(AlmaFilter *module) : LRModuleWidget(module)
 
 
 void AlmaFilter::process(const ProcessArgs &args) {
-    float frqcv = inputs[CUTOFF_CV_INPUT].getVoltage() * 0.1f * dsp::quadraticBipolar(params[CUTOFF_CV_PARAM].getValue());
-    float rescv = inputs[RESONANCE_CV_INPUT].getVoltage() * 0.1f * dsp::quadraticBipolar(params[RESONANCE_CV_PARAM].getValue());
-    float drvcv = inputs[DRIVE_CV_INPUT].getVoltage() * 0.1f * dsp::quadraticBipolar(params[DRIVE_CV_PARAM].getValue());
-
-    filter->setFrequency(params[CUTOFF_PARAM].getValue() + frqcv);
-    filter->setResonance(params[RESONANCE_PARAM].getValue() + rescv);
-    filter->setDrive(params[DRIVE_PARAM].getValue() + drvcv);
-    filter->setSlope(params[SLOPE_PARAM].getValue());
-
+    /* follow the polyphony of the audio input */
+    int channels = std::max(1, inputs[FILTER_INPUT].getChannels());
+    int groups = (channels + float4::SIZE - 1) / float4::SIZE;
+
+    /* CV and coefficients at control rate, the filter ramps the cutoff in between */
+    if (isControlTick()) {
+        float frq[MAX_VOICES], res[MAX_VOICES], drv[MAX_VOICES];
+
+        /* monophonic CV is applied to all voices */
+        for (int c = 0; c < MAX_VOICES; c++) {
+            float frqcv = inputs[CUTOFF_CV_INPUT].getPolyVoltage(c) * 0.1f * dsp::quadraticBipolar(params[CUTOFF_CV_PARAM].getValue());
+            float rescv = inputs[RESONANCE_CV_INPUT].getPolyVoltage(c) * 0.1f * dsp::quadraticBipolar(params[RESONANCE_CV_PARAM].getValue());
+            float drvcv = inputs[DRIVE_CV_INPUT].getPolyVoltage(c) * 0.1f * dsp::quadraticBipolar(params[DRIVE_CV_PARAM].getValue());
+
+            frq[c] = params[CUTOFF_PARAM].getValue() + frqcv;
+            res[c] = params[RESONANCE_PARAM].getValue() + rescv;
+            drv[c] = params[DRIVE_PARAM].getValue() + drvcv;
+        }
+
+        for (int i = 0; i < GROUPS; i++) {
+            filter[i]->setRampLength(getControlRate());
+
+            filter[i]->setFrequency(float4::load(&frq[i * float4::SIZE]));
+            filter[i]->setResonance(float4::load(&res[i * float4::SIZE]));
+            filter[i]->setDrive(float4::load(&drv[i * float4::SIZE]));
+            filter[i]->setSlope(params[SLOPE_PARAM].getValue());
+        }
+
+
+        /* pass modulated parameter of the first voice to knob widget for cv indicator */
+        reflect->frqKnob->setIndicatorActive(inputs[CUTOFF_CV_INPUT].isConnected());
+        reflect->peakKnob->setIndicatorActive(inputs[RESONANCE_CV_INPUT].isConnected());
+        reflect->driveKnob->setIndicatorActive(inputs[DRIVE_CV_INPUT].isConnected());
+
+        reflect->frqKnob->setIndicatorValue(frq[0]);
+        reflect->peakKnob->setIndicatorValue(res[0]);
+        reflect->driveKnob->setIndicatorValue(drv[0]);
+    }
 
-    /* pass modulated parameter to knob widget for cv indicator */
-    reflect->frqKnob->setIndicatorActive(inputs[CUTOFF_CV_INPUT].isConnected());
-    reflect->peakKnob->setIndicatorActive(inputs[RESONANCE_CV_INPUT].isConnected());
-    reflect->driveKnob->setIndicatorActive(inputs[DRIVE_CV_INPUT].isConnected());
+    outputs[LP_OUTPUT].setChannels(channels);
 
-    reflect->frqKnob->setIndicatorValue(params[CUTOFF_PARAM].getValue() + frqcv);
-    reflect->peakKnob->setIndicatorValue(params[RESONANCE_PARAM].getValue() + rescv);
-    reflect->driveKnob->setIndicatorValue(params[DRIVE_PARAM].getValue() + drvcv);
+    float light = 0.f;
 
+    for (int i = 0; i < groups; i++) {
+        int c = i * float4::SIZE;
 
-    float y = inputs[FILTER_INPUT].getVoltage();
+        filter[i]->setIn(float4::load(&inputs[FILTER_INPUT].voltages[c]));
+        filter[i]->process();
 
-    filter->setIn(y);
-    filter->process();
+        filter[i]->getLpOut().store(&outputs[LP_OUTPUT].voltages[c]);
 
-    outputs[LP_OUTPUT].setVoltage(filter->getLpOut());
+        /* the overload light shows the loudest active voice */
+        for (int j = 0; j < float4::SIZE && c + j < channels; j++) {
+            light = std::max(light, filter[i]->getLightValue()[j]);
+        }
+    }
 
-    lights[OVERLOAD_LIGHT].value = filter->getLightValue();
+    lights[OVERLOAD_LIGHT].value = light;
 }
 
 
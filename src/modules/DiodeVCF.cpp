@@ -1,6 +1,7 @@
 #include <dsp/common.hpp>
 #include "../LindenbergResearch.hpp"
 #include "../dsp/DiodeLadder.hpp"
+#include "../dsp/SIMDDiodeLadder.hpp"
 #include "../dsp/Hardclip.hpp"
 #include "../LRModel.hpp"
 
@@ -9,6 +10,7 @@ using namespace rack;
 using namespace lrt;
 
 using lrt::DiodeLadderFilter;
+using lrt::SIMDDiodeLadder;
 
 struct DiodeVCFWidget;
 
@@ -39,6 +41,10 @@ struct DiodeVCF : LRModule {
         NUM_LIGHTS
     };
 
+    static const int CONTROL_RATE = 16;
+    static const int MAX_VOICES = 16;
+    static const int GROUPS = MAX_VOICES / float4::SIZE;
+
 
     DiodeVCF() : LRModule(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS) {
         configParam(FREQUENCY_PARAM, 0.f, 1.0f, 0.f);
@@ -48,16 +54,61 @@ struct DiodeVCF : LRModule {
         configParam(FREQUENCY_CV_PARAM, -1.f, 1.0f, 0.f);
         configParam(RESONANCE_CV_PARAM, -1.f, 1.0f, 0.f);
         configParam(SATURATE_CV_PARAM, -1.f, 1.0f, 0.f);
+
+        setControlRate(CONTROL_RATE);
+
+        /* all voices up front, nothing is allocated on the audio thread */
+        for (int i = 0; i < GROUPS; i++) {
+            lpf[i] = new SIMDDiodeLadder<float4>(APP->engine->getSampleRate());
+        }
+    }
+
+
+    ~DiodeVCF() {
+        for (int i = 0; i < GROUPS; i++) {
+            delete lpf[i];
+        }
     }
 
 
-    DiodeLadderFilter *lpf = new DiodeLadderFilter(APP->engine->getSampleRate());
+    /* one engine per 4 voices */
+    SIMDDiodeLadder<float4> *lpf[GROUPS];
     LRPanel *panel;
 
     DiodeVCFWidget *reflect;
 
     bool aged = false;
     bool hidef = false;
+    bool lowLatency = false;
+
+
+    json_t *dataToJson() override {
+        json_t *rootJ = LRModule::dataToJson();
+        json_object_set_new(rootJ, "hidef", json_boolean(hidef));
+        json_object_set_new(rootJ, "lowlatency", json_boolean(lowLatency));
+
+        return rootJ;
+    }
+
+
+    void dataFromJson(json_t *rootJ) override {
+        LRModule::dataFromJson(rootJ);
+
+        json_t *hidefJ = json_object_get(rootJ, "hidef");
+        json_t *lowLatencyJ = json_object_get(rootJ, "lowlatency");
+
+        if (hidefJ)
+            hidef = json_boolean_value(hidefJ);
+
+        if (lowLatencyJ)
+            lowLatency = json_boolean_value(lowLatencyJ);
+    }
+
+
+    double getLatency() override {
+        return lpf[0]->getLatency();
+    }
+
 
     void process(const ProcessArgs &args) override;
     void onSampleRateChange() override;
@@ -66,7 +117,10 @@ struct DiodeVCF : LRModule {
 
 void DiodeVCF::onSampleRateChange() {
     Module::onSampleRateChange();
-    lpf->setSamplerate(APP->engine->getSampleRate());
+
+    for (int i = 0; i < GROUPS; i++) {
+        lpf[i]->setSamplerate(APP->engine->getSampleRate());
+    }
 }
 
 
@@ -128,54 +182,118 @@ struct DiodeVCFWidget : LRModuleWidget {
         addOutput(createOutput<LRIOPortAudio>(Vec(106.4, 318.5), module, DiodeVCF::HP_OUTPUT));
         // ***** OUTPUTS *********
     }
+
+
+    void appendContextMenu(Menu *menu) override;
 };
 
 
-void DiodeVCF::process(const ProcessArgs &args) {
-    float freqcv = 0, rescv = 0, satcv = 0;
+struct DiodeVCFHidef : MenuItem {
+    DiodeVCF *diodeVCF;
+
 
-    if (inputs[FREQUCENCY_CV_INPUT].isConnected()) {
-        freqcv = inputs[FREQUCENCY_CV_INPUT].getVoltage() / 10 * dsp::quadraticBipolar(params[FREQUENCY_CV_PARAM].getValue());
+    void onAction(const event::Action &e) override {
+        diodeVCF->hidef ^= true;
     }
 
 
-    if (inputs[RESONANCE_CV_INPUT].isConnected()) {
-        rescv = inputs[RESONANCE_CV_INPUT].getVoltage() / 10 * dsp::quadraticBipolar(params[RESONANCE_CV_PARAM].getValue());
+    void step() override {
+        rightText = CHECKMARK(diodeVCF->hidef);
     }
+};
 
-    if (inputs[SATURATE_CV_INPUT].isConnected()) {
-        satcv = inputs[SATURATE_CV_INPUT].getVoltage() / 10 * dsp::quadraticBipolar(params[SATURATE_CV_PARAM].getValue());
+
+struct DiodeVCFLowLatency : MenuItem {
+    DiodeVCF *diodeVCF;
+
+
+    void onAction(const event::Action &e) override {
+        diodeVCF->lowLatency ^= true;
     }
 
-    float frq = clamp(params[FREQUENCY_PARAM].getValue() + freqcv, 0.f, 1.f);
-    float res = clamp((params[RES_PARAM].getValue() + rescv) * DiodeLadderFilter::MAX_RESONANCE, 0.f, DiodeLadderFilter::MAX_RESONANCE);
-    float sat = clamp(dsp::quarticBipolar((params[SATURATE_PARAM].getValue()) + satcv) * 14 + 1, 0.f, 15.f);
 
-    reflect->frqKnob->setIndicatorActive(inputs[FREQUCENCY_CV_INPUT].isConnected());
-    reflect->resKnob->setIndicatorActive(inputs[RESONANCE_CV_INPUT].isConnected());
-    reflect->saturateKnob->setIndicatorActive(inputs[SATURATE_CV_INPUT].isConnected());
+    void step() override {
+        rightText = CHECKMARK(diodeVCF->lowLatency);
+    }
+};
 
-    reflect->frqKnob->setIndicatorValue(params[FREQUENCY_PARAM].getValue() + freqcv);
-    reflect->resKnob->setIndicatorValue(params[RES_PARAM].getValue() + rescv);
-    reflect->saturateKnob->setIndicatorValue(params[SATURATE_PARAM].getValue() + satcv);
 
-    lpf->setFrequency(frq);
-    lpf->setResonance(res);
-    lpf->setSaturation(sat);
+void DiodeVCFWidget::appendContextMenu(Menu *menu) {
+    LRModuleWidget::appendContextMenu(menu);
 
-    lpf->low = !hidef;
+    auto *diodeVCF = dynamic_cast<DiodeVCF *>(module);
+    if (!diodeVCF) return;
 
-    lpf->setIn(inputs[FILTER_INPUT].getVoltage() / 10.f);
-    lpf->invalidate();
-    lpf->process();
+    menu->addChild(new MenuLabel());
 
-    /* compensate gain drop on resonance inc.
-    float q = params[RES_PARAM].getValue() * 1.8f + 1;*/
+    auto *hidefItem = createMenuItem<DiodeVCFHidef>("Oversampling");
+    hidefItem->diodeVCF = diodeVCF;
+    menu->addChild(hidefItem);
 
-    outputs[HP_OUTPUT].setVoltage(lpf->getOut2() * 6.5f);  // hipass
-    outputs[LP_OUTPUT].setVoltage(lpf->getOut() * 10.f);   // lowpass
+    auto *lowLatencyItem = createMenuItem<DiodeVCFLowLatency>("Low latency (minimum phase)");
+    lowLatencyItem->diodeVCF = diodeVCF;
+    menu->addChild(lowLatencyItem);
 }
 
-//TODO: [2019-05-23 10:32] => recover oversampling menu
+
+void DiodeVCF::process(const ProcessArgs &args) {
+    /* follow the polyphony of the audio input */
+    int channels = std::max(1, inputs[FILTER_INPUT].getChannels());
+    int groups = (channels + float4::SIZE - 1) / float4::SIZE;
+
+    /* CV and coefficients at control rate, the filter ramps the cutoff in between */
+    if (isControlTick()) {
+        float frq[MAX_VOICES], res[MAX_VOICES], sat[MAX_VOICES];
+
+        /* monophonic CV is applied to all voices */
+        for (int c = 0; c < MAX_VOICES; c++) {
+            float freqcv = inputs[FREQUCENCY_CV_INPUT].getPolyVoltage(c) / 10 * dsp::quadraticBipolar(params[FREQUENCY_CV_PARAM].getValue());
+            float rescv = inputs[RESONANCE_CV_INPUT].getPolyVoltage(c) / 10 * dsp::quadraticBipolar(params[RESONANCE_CV_PARAM].getValue());
+            float satcv = inputs[SATURATE_CV_INPUT].getPolyVoltage(c) / 10 * dsp::quadraticBipolar(params[SATURATE_CV_PARAM].getValue());
+
+            frq[c] = clamp(params[FREQUENCY_PARAM].getValue() + freqcv, 0.f, 1.f);
+            res[c] = clamp((params[RES_PARAM].getValue() + rescv) * DiodeLadderFilter::MAX_RESONANCE, 0.f, DiodeLadderFilter::MAX_RESONANCE);
+            sat[c] = clamp(dsp::quarticBipolar((params[SATURATE_PARAM].getValue()) + satcv) * 14 + 1, 0.f, 15.f);
+
+            /* knob indicators show the first voice */
+            if (c == 0) {
+                reflect->frqKnob->setIndicatorValue(params[FREQUENCY_PARAM].getValue() + freqcv);
+                reflect->resKnob->setIndicatorValue(params[RES_PARAM].getValue() + rescv);
+                reflect->saturateKnob->setIndicatorValue(params[SATURATE_PARAM].getValue() + satcv);
+            }
+        }
+
+        reflect->frqKnob->setIndicatorActive(inputs[FREQUCENCY_CV_INPUT].isConnected());
+        reflect->resKnob->setIndicatorActive(inputs[RESONANCE_CV_INPUT].isConnected());
+        reflect->saturateKnob->setIndicatorActive(inputs[SATURATE_CV_INPUT].isConnected());
+
+        for (int i = 0; i < GROUPS; i++) {
+            lpf[i]->setRampLength(getControlRate());
+
+            lpf[i]->setFrequency(float4::load(&frq[i * float4::SIZE]));
+            lpf[i]->setResonance(float4::load(&res[i * float4::SIZE]));
+            lpf[i]->setSaturation(float4::load(&sat[i * float4::SIZE]));
+
+            lpf[i]->setLow(!hidef);
+            lpf[i]->setLowLatency(lowLatency);
+        }
+    }
+
+    outputs[LP_OUTPUT].setChannels(channels);
+    outputs[HP_OUTPUT].setChannels(channels);
+
+    for (int i = 0; i < groups; i++) {
+        int c = i * float4::SIZE;
+
+        lpf[i]->setIn(float4::load(&inputs[FILTER_INPUT].voltages[c]) / 10.f);
+        lpf[i]->process();
+
+        /* compensate gain drop on resonance inc.
+        float q = params[RES_PARAM].getValue() * 1.8f + 1;*/
+
+        (lpf[i]->getOut2() * 6.5f).store(&outputs[HP_OUTPUT].voltages[c]);  // hipass
+        (lpf[i]->getOut() * 10.f).store(&outputs[LP_OUTPUT].voltages[c]);   // lowpass
+    }
+}
 
 Model *modelDiodeVCF = createModel<DiodeVCF, DiodeVCFWidget>("DIODE_VCF");
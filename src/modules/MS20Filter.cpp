@@ -1,4 +1,4 @@
-#include "../dsp/MS20zdf.hpp"
+#include "../dsp/SIMDMS20zdf.hpp"
 #include "../LindenbergResearch.hpp"
 #include "../LRModel.hpp"
 
@@ -6,6 +6,8 @@
 using namespace rack;
 using namespace lrt;
 
+using lrt::SIMDMS20zdf;
+
 struct MS20FilterWidget;
 
 
@@ -39,10 +41,18 @@ struct MS20Filter : LRModule {
         NUM_LIGHTS
     };
 
-    lrt::MS20zdf *ms20zdf = new lrt::MS20zdf(APP->engine->getSampleRate());
+    static const int CONTROL_RATE = 16;
+    static const int MAX_VOICES = 16;
+    static const int GROUPS = MAX_VOICES / float4::SIZE;
+
+    /* one engine per 4 voices, allocated up front so nothing is created on the audio thread */
+    SIMDMS20zdf<float4> *ms20zdf[GROUPS];
 
     MS20FilterWidget *reflect;
 
+    /* minimum phase oversampling, applied on the audio thread */
+    bool lowLatency = false;
+
 
     MS20Filter() : LRModule(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS) {
         configParam(FREQUENCY_PARAM, 0.f, 1.f, 1.f);
@@ -54,6 +64,42 @@ struct MS20Filter : LRModule {
         configParam(GAIN_CV_PARAM, -1.f, 1.0f, 0.f);
 
         configParam(MODE_SWITCH_PARAM, 0.0, 1.0, 1.0);
+
+        setControlRate(CONTROL_RATE);
+
+        for (int i = 0; i < GROUPS; i++) {
+            ms20zdf[i] = new SIMDMS20zdf<float4>(APP->engine->getSampleRate());
+        }
+    }
+
+
+    ~MS20Filter() {
+        for (int i = 0; i < GROUPS; i++) {
+            delete ms20zdf[i];
+        }
+    }
+
+
+    json_t *dataToJson() override {
+        json_t *rootJ = LRModule::dataToJson();
+        json_object_set_new(rootJ, "lowlatency", json_boolean(lowLatency));
+
+        return rootJ;
+    }
+
+
+    void dataFromJson(json_t *rootJ) override {
+        LRModule::dataFromJson(rootJ);
+
+        json_t *lowLatencyJ = json_object_get(rootJ, "lowlatency");
+
+        if (lowLatencyJ)
+            lowLatency = json_boolean_value(lowLatencyJ);
+    }
+
+
+    double getLatency() override {
+        return ms20zdf[0]->getLatency();
     }
 
 
@@ -64,7 +110,10 @@ struct MS20Filter : LRModule {
 
 void MS20Filter::onSampleRateChange() {
     Module::onSampleRateChange();
-    ms20zdf->updateSampleRate(APP->engine->getSampleRate());
+
+    for (int i = 0; i < GROUPS; i++) {
+        ms20zdf[i]->setSamplerate(APP->engine->getSampleRate());
+    }
 }
 
 
@@ -77,9 +126,39 @@ struct MS20FilterWidget : LRModuleWidget {
     LRMiddleKnob *driveKnob;
 
     MS20FilterWidget(MS20Filter *module);
+    void appendContextMenu(Menu *menu) override;
 };
 
 
+struct MS20FilterLowLatency : MenuItem {
+    MS20Filter *ms20filter;
+
+
+    void onAction(const event::Action &e) override {
+        ms20filter->lowLatency ^= true;
+    }
+
+
+    void step() override {
+        rightText = CHECKMARK(ms20filter->lowLatency);
+    }
+};
+
+
+void MS20FilterWidget::appendContextMenu(Menu *menu) {
+    LRModuleWidget::appendContextMenu(menu);
+
+    auto *ms20filter = dynamic_cast<MS20Filter *>(module);
+    if (!ms20filter) return;
+
+    menu->addChild(new MenuLabel());
+
+    auto *lowLatencyItem = createMenuItem<MS20FilterLowLatency>("Low latency (minimum phase)");
+    lowLatencyItem->ms20filter = ms20filter;
+    menu->addChild(lowLatencyItem);
+}
+
+
 MS20FilterWidget::MS20FilterWidget(MS20Filter *module) : LRModuleWidget(module) {
     panel->addSVGVariant(LRGestaltType::DARK, APP->window->loadSvg(asset::plugin(pluginInstance, "res/panels/MS20.svg")));
     panel->addSVGVariant(LRGestaltType::LIGHT, APP->window->loadSvg(asset::plugin(pluginInstance, "res/panels/MS20Light.svg")));
@@ -134,31 +213,57 @@ MS20FilterWidget::MS20FilterWidget(MS20Filter *module) : LRModuleWidget(module)
 
 
 void MS20Filter::process(const ProcessArgs &args) {
-    /* compute control voltages */
-    float frqcv = inputs[CUTOFF_CV_INPUT].getVoltage() * 0.1f * dsp::quadraticBipolar(params[CUTOFF_CV_PARAM].getValue());
-    float peakcv = inputs[PEAK_CV_INPUT].getVoltage() * 0.1f * dsp::quadraticBipolar(params[PEAK_CV_PARAM].getValue());
-    float gaincv = inputs[GAIN_CV_INPUT].getVoltage() * 0.1f * dsp::quadraticBipolar(params[GAIN_CV_PARAM].getValue());
-
-    /* set cv modulated parameters */
-    ms20zdf->setFrequency(params[FREQUENCY_PARAM].getValue() + frqcv);
-    ms20zdf->setPeak(params[PEAK_PARAM].getValue() + peakcv);
-    ms20zdf->setDrive(params[DRIVE_PARAM].getValue() + gaincv);
-
-    /* pass modulated parameter to knob widget for cv indicator */
-    reflect->frqKnob->setIndicatorActive(inputs[CUTOFF_CV_INPUT].isConnected());
-    reflect->peakKnob->setIndicatorActive(inputs[PEAK_CV_INPUT].isConnected());
-    reflect->driveKnob->setIndicatorActive(inputs[GAIN_CV_INPUT].isConnected());
+    /* follow the polyphony of the audio input */
+    int channels = std::max(1, inputs[FILTER_INPUT].getChannels());
+    int groups = (channels + float4::SIZE - 1) / float4::SIZE;
+
+    /* CV and coefficients at control rate, the filter ramps the cutoff in between */
+    if (isControlTick()) {
+        float frq[MAX_VOICES], peak[MAX_VOICES], drive[MAX_VOICES];
+
+        /* compute control voltages, monophonic CV is applied to all voices */
+        for (int c = 0; c < MAX_VOICES; c++) {
+            float frqcv = inputs[CUTOFF_CV_INPUT].getPolyVoltage(c) * 0.1f * dsp::quadraticBipolar(params[CUTOFF_CV_PARAM].getValue());
+            float peakcv = inputs[PEAK_CV_INPUT].getPolyVoltage(c) * 0.1f * dsp::quadraticBipolar(params[PEAK_CV_PARAM].getValue());
+            float gaincv = inputs[GAIN_CV_INPUT].getPolyVoltage(c) * 0.1f * dsp::quadraticBipolar(params[GAIN_CV_PARAM].getValue());
+
+            frq[c] = params[FREQUENCY_PARAM].getValue() + frqcv;
+            peak[c] = params[PEAK_PARAM].getValue() + peakcv;
+            drive[c] = params[DRIVE_PARAM].getValue() + gaincv;
+        }
+
+        /* set cv modulated parameters */
+        for (int i = 0; i < GROUPS; i++) {
+            ms20zdf[i]->setRampLength(getControlRate());
+
+            ms20zdf[i]->setFrequency(float4::load(&frq[i * float4::SIZE]));
+            ms20zdf[i]->setPeak(float4::load(&peak[i * float4::SIZE]));
+            ms20zdf[i]->setDrive(float4::load(&drive[i * float4::SIZE]));
+        }
+
+        /* pass modulated parameter of the first voice to knob widget for cv indicator */
+        reflect->frqKnob->setIndicatorActive(inputs[CUTOFF_CV_INPUT].isConnected());
+        reflect->peakKnob->setIndicatorActive(inputs[PEAK_CV_INPUT].isConnected());
+        reflect->driveKnob->setIndicatorActive(inputs[GAIN_CV_INPUT].isConnected());
+
+        reflect->frqKnob->setIndicatorValue(frq[0]);
+        reflect->peakKnob->setIndicatorValue(peak[0]);
+        reflect->driveKnob->setIndicatorValue(drive[0]);
+    }
 
-    reflect->frqKnob->setIndicatorValue(params[FREQUENCY_PARAM].getValue() + frqcv);
-    reflect->peakKnob->setIndicatorValue(params[PEAK_PARAM].getValue() + peakcv);
-    reflect->driveKnob->setIndicatorValue(params[DRIVE_PARAM].getValue() + gaincv);
+    outputs[FILTER_OUTPUT].setChannels(channels);
 
     /* process signal */
-    ms20zdf->setType(params[MODE_SWITCH_PARAM].getValue());
-    ms20zdf->setIn(inputs[FILTER_INPUT].getVoltage());
-    ms20zdf->process();
+    for (int i = 0; i < groups; i++) {
+        int c = i * float4::SIZE;
 
-    outputs[FILTER_OUTPUT].setVoltage(ms20zdf->getLPOut());
+        ms20zdf[i]->setType(params[MODE_SWITCH_PARAM].getValue());
+        ms20zdf[i]->setLowLatency(lowLatency);
+        ms20zdf[i]->setIn(float4::load(&inputs[FILTER_INPUT].voltages[c]));
+        ms20zdf[i]->process();
+
+        ms20zdf[i]->getLPOut().store(&outputs[FILTER_OUTPUT].voltages[c]);
+    }
 }
 
 
@@ -1,3 +1,4 @@
+#include "../dsp/SIMDStilsonFilter.hpp"
 #include "../LindenbergResearch.hpp"
 #include "../LRModel.hpp"
 
@@ -29,59 +30,84 @@ struct SimpleFilter : LRModule {
         NUM_LIGHTS
     };
 
-    float f, p, q;
-    float b0, b1, b2, b3, b4;
-    float t1, t2;
-    float frequency, resonance, in;
+    static const int CONTROL_RATE = 32;
+    static const int MAX_VOICES = 16;
+    static const int GROUPS = MAX_VOICES / float4::SIZE;
+
+    typedef SIMDStilsonFilter<float4> Filter;
+
+    /* one engine per 4 voices, allocated up front so nothing is created on the audio thread */
+    Filter *filter[GROUPS];
+
+    /* internal rate and output tap, applied on the audio thread */
+    int oversample = 1;
+    Filter::Tap tap = Filter::LOWPASS;
 
     SimpleFilterWidget *reflect;
 
 
     SimpleFilter() : LRModule(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS) {
-        f = 0;
-        p = 0;
-        q = 0;
-        b0 = 0;
-        b1 = 0;
-        b2 = 0;
-        b3 = 0;
-        b4 = 0;
-        t1 = 0;
-        t2 = 0;
-        frequency = 0;
-        resonance = 0;
-        in = 0;
-
         configParam(CUTOFF_PARAM, 0.f, 1.f, 0.f);
         configParam(RESONANCE_PARAM, 0.f, 1.f, 0.f);
         configParam(CUTOFF_CV_PARAM, 0.f, 1.f, 0.f);
         configParam(RESONANCE_CV_PARAM, 0.f, 1.f, 0.f);
+
+        setControlRate(CONTROL_RATE);
+
+        for (int i = 0; i < GROUPS; i++) {
+            filter[i] = new Filter(APP->engine->getSampleRate());
+        }
     }
 
 
-    void process(const ProcessArgs &args) override;
+    ~SimpleFilter() {
+        for (int i = 0; i < GROUPS; i++) {
+            delete filter[i];
+        }
+    }
 
 
-    // For more advanced Module features, read Rack's engine.hpp header file
-    // - dataToJson, dataFromJson: serialization of internal data
-    // - onSampleRateChange: event triggered by a change of sample rate
-    // - reset, randomize: implements special behavior when user clicks these from the context menu
-};
+    json_t *dataToJson() override {
+        json_t *rootJ = LRModule::dataToJson();
+        json_object_set_new(rootJ, "oversample", json_integer(oversample));
+        json_object_set_new(rootJ, "tap", json_integer(tap));
+
+        return rootJ;
+    }
+
+
+    void dataFromJson(json_t *rootJ) override {
+        LRModule::dataFromJson(rootJ);
+
+        json_t *oversampleJ = json_object_get(rootJ, "oversample");
+        json_t *tapJ = json_object_get(rootJ, "tap");
+
+        if (oversampleJ) {
+            int factor = (int) json_integer_value(oversampleJ);
+            oversample = factor == 2 || factor == 4 ? factor : 1;
+        }
+
+        if (tapJ)
+            tap = (Filter::Tap) clamp((int) json_integer_value(tapJ), (int) Filter::LOWPASS, (int) Filter::BANDPASS);
+    }
 
 
-float clip(float in, float level) {
-    // clipping high
-    if (in > level) {
-        in = level;
+    void onSampleRateChange() override {
+        LRModule::onSampleRateChange();
+
+        for (int i = 0; i < GROUPS; i++) {
+            filter[i]->setSamplerate(APP->engine->getSampleRate());
+        }
     }
 
-    // clipping low
-    if (in < -level) {
-        in = -level;
+
+    double getLatency() override {
+        return filter[0]->getLatency();
     }
 
-    return in;
-}
+
+    void process(const ProcessArgs &args) override;
+};
 
 
 /**
@@ -92,9 +118,73 @@ struct SimpleFilterWidget : LRModuleWidget {
     LRMiddleKnob *resKnob;
 
     SimpleFilterWidget(SimpleFilter *module);
+    void appendContextMenu(Menu *menu) override;
+};
+
+
+struct SimpleFilterOversample : MenuItem {
+    SimpleFilter *simpleFilter;
+    int oversample;
+
+
+    void onAction(const event::Action &e) override {
+        simpleFilter->oversample = oversample;
+    }
+
+
+    void step() override {
+        rightText = CHECKMARK(simpleFilter->oversample == oversample);
+    }
 };
 
 
+struct SimpleFilterTap : MenuItem {
+    SimpleFilter *simpleFilter;
+    SimpleFilter::Filter::Tap tap;
+
+
+    void onAction(const event::Action &e) override {
+        simpleFilter->tap = tap;
+    }
+
+
+    void step() override {
+        rightText = CHECKMARK(simpleFilter->tap == tap);
+    }
+};
+
+
+void SimpleFilterWidget::appendContextMenu(Menu *menu) {
+    LRModuleWidget::appendContextMenu(menu);
+
+    auto *simpleFilter = dynamic_cast<SimpleFilter *>(module);
+    if (!simpleFilter) return;
+
+    menu->addChild(new MenuLabel());
+
+    const char *oversampleNames[] = {"No oversampling", "2x oversampling", "4x oversampling"};
+    const int oversampleFactors[] = {1, 2, 4};
+
+    for (int i = 0; i < 3; i++) {
+        auto *item = createMenuItem<SimpleFilterOversample>(oversampleNames[i]);
+        item->simpleFilter = simpleFilter;
+        item->oversample = oversampleFactors[i];
+        menu->addChild(item);
+    }
+
+    menu->addChild(new MenuLabel());
+
+    const char *tapNames[] = {"Lowpass output", "Highpass output", "Bandpass output"};
+
+    for (int i = 0; i < 3; i++) {
+        auto *item = createMenuItem<SimpleFilterTap>(tapNames[i]);
+        item->simpleFilter = simpleFilter;
+        item->tap = (SimpleFilter::Filter::Tap) i;
+        menu->addChild(item);
+    }
+}
+
+
 SimpleFilterWidget::SimpleFilterWidget(SimpleFilter *module) : LRModuleWidget(module) {
     panel->addSVGVariant(LRGestaltType::DARK, APP->window->loadSvg(asset::plugin(pluginInstance, "res/panels/SimpleFilter.svg")));
     //panel->addSVGVariant(APP->window->loadSvg(asset::plugin(plugin, "res/panels/SimpleFilter.svg")));
@@ -145,63 +235,55 @@ SimpleFilterWidget::SimpleFilterWidget(SimpleFilter *module) : LRModuleWidget(mo
 
 
 void SimpleFilter::process(const ProcessArgs &args) {
-    // Moog 24 dB/oct resonant lowpass VCF
-    // References: CSound source code, Stilson/Smith CCRMA paper.
-    // Modified by paul.kellett@maxim.abel.co.uk July 2000
-    //
-    // Adapted for VCV Rack by Lindenberg Research
-    // http://musicdsp.org/showArchiveComment.php?ArchiveID=25
+    /* follow the polyphony of the audio input */
+    int channels = std::max(1, inputs[FILTER_INPUT].getChannels());
+    int groups = (channels + float4::SIZE - 1) / float4::SIZE;
 
-    // calculate CV inputs
-    float cutoffCVValue = (inputs[CUTOFF_CV_INPUT].getVoltage() * 0.05f * params[CUTOFF_CV_PARAM].getValue());
-    float resonanceCVValue = (inputs[RESONANCE_CV_INPUT].getVoltage() * 0.1f * params[RESONANCE_CV_PARAM].getValue());
+    /* CV and cutoff mapping at control rate, the cutoff is ramped per sample in between */
+    if (isControlTick()) {
+        float frq[MAX_VOICES], res[MAX_VOICES];
 
-    // translate frequency to logarithmic scale
-    float freqHz = 20.f * powf(1000.f, params[CUTOFF_PARAM].getValue() + cutoffCVValue);
-    frequency = clip(freqHz * (1.f / (args.sampleRate / 2.0f)), 1.f);
-    resonance = clip(params[RESONANCE_PARAM].getValue() + resonanceCVValue, 1.f);
+        // calculate CV inputs, monophonic CV is applied to all voices
+        for (int c = 0; c < MAX_VOICES; c++) {
+            float cutoffCVValue = (inputs[CUTOFF_CV_INPUT].getPolyVoltage(c) * 0.05f * params[CUTOFF_CV_PARAM].getValue());
+            float resonanceCVValue = (inputs[RESONANCE_CV_INPUT].getPolyVoltage(c) * 0.1f * params[RESONANCE_CV_PARAM].getValue());
 
-    reflect->frqKnob->setIndicatorActive(inputs[CUTOFF_CV_INPUT].isConnected());
-    reflect->resKnob->setIndicatorActive(inputs[RESONANCE_CV_INPUT].isConnected());
+            frq[c] = params[CUTOFF_PARAM].getValue() + cutoffCVValue;
+            res[c] = params[RESONANCE_PARAM].getValue() + resonanceCVValue;
+        }
 
-    reflect->frqKnob->setIndicatorValue(params[CUTOFF_PARAM].getValue() + cutoffCVValue);
-    reflect->resKnob->setIndicatorValue(params[RESONANCE_PARAM].getValue() + resonanceCVValue);
+        for (int i = 0; i < GROUPS; i++) {
+            filter[i]->setRampLength(getControlRate());
 
+            filter[i]->setFrequency(float4::load(&frq[i * float4::SIZE]));
+            filter[i]->setResonance(float4::load(&res[i * float4::SIZE]));
+        }
 
-    // normalize signal input to [-1.0...+1.0]
-    // lpf starts to be very unstable for input gain above 1.f and below 0.f
-    in = clip(inputs[FILTER_INPUT].getVoltage() * 0.1f, 1.0f);
+        reflect->frqKnob->setIndicatorActive(inputs[CUTOFF_CV_INPUT].isConnected());
+        reflect->resKnob->setIndicatorActive(inputs[RESONANCE_CV_INPUT].isConnected());
 
-    // Set coefficients given frequency & resonance [0.0...1.0]
-    q = 1.0f - frequency;
-    p = frequency + 0.8f * frequency * q;
-    f = p + p - 1.0f;
-    q = resonance * (1.0f + 0.5f * q * (1.0f - q + 5.6f * q * q));
-
-
-    in -= q * b4;
-
-    t1 = b1;
-    b1 = (in + b0) * p - b1 * f;
-
-    t2 = b2;
-    b2 = (b1 + t1) * p - b2 * f;
-
-    t1 = b3;
-    b3 = (b2 + t2) * p - b3 * f;
+        reflect->frqKnob->setIndicatorValue(frq[0]);
+        reflect->resKnob->setIndicatorValue(res[0]);
+    }
 
-    b4 = (b3 + t1) * p - b4 * f;
+    outputs[FILTER_OUTPUT].setChannels(channels);
 
-    b4 = b4 - b4 * b4 * b4 * 0.166666667f;
-    b0 = in;
+    for (int i = 0; i < groups; i++) {
+        int c = i * float4::SIZE;
 
-    // Lowpass  output:  b4
-    // Highpass output:  in - b4;
-    // Bandpass output:  3.0f * (b3 - b4);
+        filter[i]->setOversample(oversample);
+        filter[i]->setTap(tap);
 
+        // normalize signal input to [-1.0...+1.0]
+        // lpf starts to be very unstable for input gain above 1.f and below 0.f
+        float4 in = float4::load(&inputs[FILTER_INPUT].voltages[c]) * 0.1f;
+        filter[i]->setIn(simd::clampf(in, float4(-1.f), float4(1.f)));
+        filter[i]->process();
 
-    // scale normalized output back to +/-5V
-    outputs[FILTER_OUTPUT].setVoltage(clip(b4, 1.0f) * 5.0f);
+        // scale normalized output back to +/-5V
+        float4 out = simd::clampf(filter[i]->getOut(), float4(-1.f), float4(1.f)) * 5.0f;
+        out.store(&outputs[FILTER_OUTPUT].voltages[c]);
+    }
 }
 
 Model *modelSimpleFilter = createModel<SimpleFilter, SimpleFilterWidget>("LPFilter24dB");
@@ -116,7 +116,7 @@ struct TestDriver : LRModule {
 
 
     json_t *dataToJson() override {
-        json_t *rootJ = json_object();
+        json_t *rootJ = LRModule::dataToJson();
         json_object_set_new(rootJ, "lcdindex", json_integer((int) lround(params[LCD_PARAM].getValue())));
 
         return rootJ;
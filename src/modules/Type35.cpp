@@ -19,13 +19,13 @@
 #include <dsp/common.hpp>
 #include "../LindenbergResearch.hpp"
 #include "../LRModel.hpp"
-#include "../dsp/Type35Filter.hpp"
+#include "../dsp/SIMDType35.hpp"
 
 
 using namespace rack;
 using namespace lrt;
 
-using lrt::Type35Filter;
+using lrt::SIMDType35;
 
 struct Type35Widget;
 
@@ -63,10 +63,14 @@ struct Type35 : LRModule {
         NUM_LIGHTS
     };
 
+    static const int CONTROL_RATE = 32;
+    static const int MAX_VOICES = 16;
+    static const int GROUPS = MAX_VOICES / float4::SIZE;
+
     Type35Widget *reflect;
 
-    Type35Filter *lpf = new Type35Filter(APP->engine->getSampleRate(), Type35Filter::LPF);
-    Type35Filter *hpf = new Type35Filter(APP->engine->getSampleRate(), Type35Filter::HPF);
+    /* lowpass and highpass for 4 voices each, allocated up front so nothing is created on the audio thread */
+    SIMDType35<float4> *filter[GROUPS];
 
     void process(const ProcessArgs &args) override;
 
@@ -85,12 +89,25 @@ struct Type35 : LRModule {
         configParam(PEAK2_CV_PARAM, -1.f, 1.0f, 0.f);
 
         // setup LCD modes
-        configParam(LCD_PARAM, 0.f, 6.0f, 0.f);
+        configParam(LCD_PARAM, 0.f, 4.0f, 0.f);
+
+        setControlRate(CONTROL_RATE);
+
+        for (int i = 0; i < GROUPS; i++) {
+            filter[i] = new SIMDType35<float4>(APP->engine->getSampleRate());
+        }
+    }
+
+
+    ~Type35() {
+        for (int i = 0; i < GROUPS; i++) {
+            delete filter[i];
+        }
     }
 
 
     json_t *dataToJson() override {
-        json_t *rootJ = json_object();
+        json_t *rootJ = LRModule::dataToJson();
         json_object_set_new(rootJ, "filtermode", json_integer((int) lround(params[LCD_PARAM].getValue())));
 
         return rootJ;
@@ -103,14 +120,25 @@ struct Type35 : LRModule {
         json_t *mode = json_object_get(rootJ, "filtermode");
 
         if (mode)
-            params[LCD_PARAM].setValue(json_integer_value(mode));
+            params[LCD_PARAM].setValue(clamp((int) json_integer_value(mode), 0, 4));
     }
 
 
     void onSampleRateChange() override {
         LRModule::onSampleRateChange();
-        lpf->setSamplerate(APP->engine->getSampleRate());
-        hpf->setSamplerate(APP->engine->getSampleRate());
+
+        for (int i = 0; i < GROUPS; i++) {
+            filter[i]->setSamplerate(APP->engine->getSampleRate());
+        }
+    }
+
+
+    /**
+     * @brief All modes run through one oversampling pass, also the serial ones
+     * @return
+     */
+    double getLatency() override {
+        return filter[0]->getLatency();
     }
 };
 
@@ -192,83 +220,73 @@ struct Type35Widget : LRModuleWidget {
 
 
 void Type35::process(const ProcessArgs &args) {
-// compute all cv values
-    float frq1cv = inputs[CUTOFF1_CV_INPUT].getVoltage() * 0.1f * dsp::quadraticBipolar(params[CUTOFF1_CV_PARAM].getValue());
-    float peak1cv = inputs[PEAK1_CV_INPUT].getVoltage() * 0.1f * dsp::quadraticBipolar(params[PEAK1_CV_PARAM].getValue());
-
-    float frq2cv = inputs[CUTOFF2_CV_INPUT].getVoltage() * 0.1f * dsp::quadraticBipolar(params[CUTOFF2_CV_PARAM].getValue());
-    float peak2cv = inputs[PEAK2_CV_INPUT].getVoltage() * 0.1f * dsp::quadraticBipolar(params[PEAK2_CV_PARAM].getValue());
-
-    float drivecv = inputs[DRIVE_CV_INPUT].getVoltage();
-
-
-// set vc parameter and knob values
-    lpf->fc = params[FREQ1_PARAM].getValue() + frq1cv;
-    lpf->peak = params[PEAK1_PARAM].getValue() + peak1cv;
-    hpf->fc = params[FREQ2_PARAM].getValue() + frq2cv;
-    hpf->peak = params[PEAK2_PARAM].getValue() + peak2cv;
+    /* follow the polyphony of the audio input, a stereo signal is patched as two channels */
+    int channels = std::max(1, inputs[FILTER_INPUT].getChannels());
+    int groups = (channels + float4::SIZE - 1) / float4::SIZE;
+
+    /* CV and coefficients at control rate, the filter ramps the cutoff in between */
+    if (isControlTick()) {
+        float frq1[MAX_VOICES], peak1[MAX_VOICES], frq2[MAX_VOICES], peak2[MAX_VOICES], drive[MAX_VOICES];
+
+        // compute all cv values, monophonic CV is applied to all voices
+        for (int c = 0; c < MAX_VOICES; c++) {
+            float frq1cv = inputs[CUTOFF1_CV_INPUT].getPolyVoltage(c) * 0.1f * dsp::quadraticBipolar(params[CUTOFF1_CV_PARAM].getValue());
+            float peak1cv = inputs[PEAK1_CV_INPUT].getPolyVoltage(c) * 0.1f * dsp::quadraticBipolar(params[PEAK1_CV_PARAM].getValue());
+
+            float frq2cv = inputs[CUTOFF2_CV_INPUT].getPolyVoltage(c) * 0.1f * dsp::quadraticBipolar(params[CUTOFF2_CV_PARAM].getValue());
+            float peak2cv = inputs[PEAK2_CV_INPUT].getPolyVoltage(c) * 0.1f * dsp::quadraticBipolar(params[PEAK2_CV_PARAM].getValue());
+
+            float drivecv = inputs[DRIVE_CV_INPUT].getPolyVoltage(c);
+
+            frq1[c] = params[FREQ1_PARAM].getValue() + frq1cv;
+            peak1[c] = params[PEAK1_PARAM].getValue() + peak1cv;
+            frq2[c] = params[FREQ2_PARAM].getValue() + frq2cv;
+            peak2[c] = params[PEAK2_PARAM].getValue() + peak2cv;
+            drive[c] = params[DRIVE_PARAM].getValue() + drivecv;
+        }
+
+        // set vc parameter
+        for (int i = 0; i < GROUPS; i++) {
+            int c = i * float4::SIZE;
+
+            filter[i]->setRampLength(getControlRate());
+
+            filter[i]->setLpFrequency(float4::load(&frq1[c]));
+            filter[i]->setLpPeak(float4::load(&peak1[c]));
+            filter[i]->setHpFrequency(float4::load(&frq2[c]));
+            filter[i]->setHpPeak(float4::load(&peak2[c]));
+            filter[i]->setSaturation(float4::load(&drive[c]));
+        }
+
+        // knob values show the first voice
+        if (reflect) {
+            reflect->frqKnobLP->setIndicatorActive(inputs[CUTOFF1_CV_INPUT].isConnected());
+            reflect->peakKnobLP->setIndicatorActive(inputs[PEAK1_CV_INPUT].isConnected());
+            reflect->frqKnobHP->setIndicatorActive(inputs[CUTOFF2_CV_INPUT].isConnected());
+            reflect->peakKnobHP->setIndicatorActive(inputs[PEAK2_CV_INPUT].isConnected());
+            reflect->driveKnob->setIndicatorActive(inputs[DRIVE_CV_INPUT].isConnected());
+
+            reflect->frqKnobLP->setIndicatorValue(frq1[0]);
+            reflect->peakKnobLP->setIndicatorValue(peak1[0]);
+            reflect->frqKnobHP->setIndicatorValue(frq2[0]);
+            reflect->peakKnobHP->setIndicatorValue(peak2[0]);
+            reflect->driveKnob->setIndicatorValue(drive[0]);
+        }
+    }
 
-    lpf->sat = params[DRIVE_PARAM].getValue() + drivecv;
-    hpf->sat = params[DRIVE_PARAM].getValue() + drivecv;
+    /* the LCD lists the modes in the order of Type35Routing */
+    auto routing = (Type35Routing) clamp((int) lround(params[LCD_PARAM].getValue()), 0, 4);
 
-    auto lcdi = params[LCD_PARAM].getValue();
+    outputs[OUTPUT].setChannels(channels);
 
-    if (reflect) {
-        reflect->frqKnobLP->setIndicatorActive(inputs[CUTOFF1_CV_INPUT].isConnected());
-        reflect->peakKnobLP->setIndicatorActive(inputs[PEAK1_CV_INPUT].isConnected());
-        reflect->frqKnobHP->setIndicatorActive(inputs[CUTOFF2_CV_INPUT].isConnected());
-        reflect->peakKnobHP->setIndicatorActive(inputs[PEAK2_CV_INPUT].isConnected());
-        reflect->driveKnob->setIndicatorActive(inputs[DRIVE_CV_INPUT].isConnected());
+    for (int i = 0; i < groups; i++) {
+        int c = i * float4::SIZE;
 
-        reflect->frqKnobLP->setIndicatorValue(params[FREQ1_PARAM].getValue() + frq1cv);
-        reflect->peakKnobLP->setIndicatorValue(params[PEAK1_PARAM].getValue() + peak1cv);
-        reflect->frqKnobHP->setIndicatorValue(params[FREQ2_PARAM].getValue() + frq2cv);
-        reflect->peakKnobHP->setIndicatorValue(params[PEAK2_PARAM].getValue() + peak2cv);
-        reflect->driveKnob->setIndicatorValue(params[DRIVE_PARAM].getValue() + drivecv);
-    }
+        filter[i]->setRouting(routing);
+        filter[i]->setIn(float4::load(&inputs[FILTER_INPUT].voltages[c]));
+        filter[i]->process();
 
-    if (lround(lcdi) == 0) {
-        hpf->in = inputs[FILTER_INPUT].getVoltage();
-        hpf->invalidate();
-        hpf->process2();
-
-        lpf->in = hpf->out;
-        lpf->invalidate();
-        lpf->process2();
-
-        outputs[OUTPUT].setVoltage(lpf->out);
-    } else if (lround(lcdi) == 1) {
-        lpf->in = inputs[FILTER_INPUT].getVoltage();
-        lpf->invalidate();
-        lpf->process2();
-
-        outputs[OUTPUT].setVoltage(lpf->out);
-    } else if (lround(lcdi) == 2) {
-        lpf->in = inputs[FILTER_INPUT].getVoltage();
-        lpf->invalidate();
-        lpf->process2();
-
-        hpf->in = inputs[FILTER_INPUT].getVoltage();
-        hpf->invalidate();
-        hpf->process2();
-
-        outputs[OUTPUT].setVoltage(hpf->out + lpf->out);
-    } else if (lround(lcdi) == 3) {
-        hpf->in = inputs[FILTER_INPUT].getVoltage();
-        hpf->invalidate();
-        hpf->process2();
-
-        outputs[OUTPUT].setVoltage(hpf->out);
-    } else if (lround(lcdi) == 4) {
-        lpf->in = inputs[FILTER_INPUT].getVoltage();
-        lpf->invalidate();
-        lpf->process2();
-
-        hpf->in = lpf->out;
-        hpf->invalidate();
-        hpf->process2();
-
-        outputs[OUTPUT].setVoltage(hpf->out);
+        filter[i]->getOut().store(&outputs[OUTPUT].voltages[c]);
     }
 }
 
@@ -17,14 +17,14 @@
 \*                                                                     */
 #include <rack.hpp>
 #include <dsp/common.hpp>
-#include "../dsp/Oscillator.hpp"
+#include "../dsp/SIMDOscillatorBank.hpp"
 #include "../LindenbergResearch.hpp"
 #include "../LRModel.hpp"
 
 using namespace rack;
 using namespace lrt;
 
-using lrt::DSPBLOscillator;
+using lrt::SIMDOscillatorBank;
 
 struct VCOWidget;
 
@@ -62,8 +62,19 @@ struct VCO : LRModule {
         NUM_LIGHTS
     };
 
+    static const int MAX_VOICES = 16;
+
+    typedef SIMDOscillatorBank<float4, MAX_VOICES> Bank;
+
     VCOWidget *reflect;
-    vector<DSPBLOscillator *> osc;
+    Bank *bank;
+
+    DSPBLOscillator::Core core = DSPBLOscillator::INTEGRATED_BLIT;
+
+    /* per voice inputs of the bank */
+    float cv[MAX_VOICES] = {};
+    float fm[MAX_VOICES] = {};
+    float pw[MAX_VOICES] = {};
 
 
     VCO() : LRModule(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS) {
@@ -78,9 +89,37 @@ struct VCO : LRModule {
         configParam(SINE_PARAM, -1.f, 1.f, 0.f, "SIN level => mixer");
         configParam(TRI_PARAM, -1.f, 1.f, 0.f, "TRI level => mixer");
 
-        osc.resize(16);
+        bank = new Bank(APP->engine->getSampleRate());
+
+        bank->out[Bank::SAW] = outputs[SAW_OUTPUT].voltages;
+        bank->out[Bank::PULSE] = outputs[PULSE_OUTPUT].voltages;
+        bank->out[Bank::SINE] = outputs[SINE_OUTPUT].voltages;
+        bank->out[Bank::TRI] = outputs[TRI_OUTPUT].voltages;
+        bank->out[Bank::NOISE] = outputs[NOISE_OUTPUT].voltages;
+    }
+
+
+    ~VCO() {
+        delete bank;
+    }
+
+
+    json_t *dataToJson() override {
+        json_t *rootJ = LRModule::dataToJson();
+        json_object_set_new(rootJ, "core", json_integer(core));
 
-        osc[0] = new DSPBLOscillator(APP->engine->getSampleRate());
+        return rootJ;
+    }
+
+
+    void dataFromJson(json_t *rootJ) override {
+        LRModule::dataFromJson(rootJ);
+
+        json_t *coreJ = json_object_get(rootJ, "core");
+
+        if (coreJ)
+            core = (DSPBLOscillator::Core) clamp((int) json_integer_value(coreJ), (int) DSPBLOscillator::INTEGRATED_BLIT,
+                                                 (int) DSPBLOscillator::POLYBLEP);
     }
 
 
@@ -91,10 +130,7 @@ struct VCO : LRModule {
 
 void VCO::onSampleRateChange() {
     Module::onSampleRateChange();
-
-    for (int i = 0; i < inputs[VOCT1_INPUT].getChannels(); i++)
-        if (osc[i] != nullptr)
-            osc[i]->updateSampleRate(APP->engine->getSampleRate());
+    bank->setSamplerate(APP->engine->getSampleRate());
 }
 
 /*
@@ -111,9 +147,45 @@ struct VCOWidget : LRModuleWidget {
     LRBigKnob *frqKnob = NULL;
 
     VCOWidget(VCO *module);
+    void appendContextMenu(Menu *menu) override;
 };
 
 
+struct VCOCore : MenuItem {
+    VCO *vco;
+    DSPBLOscillator::Core core;
+
+
+    void onAction(const event::Action &e) override {
+        vco->core = core;
+    }
+
+
+    void step() override {
+        rightText = CHECKMARK(vco->core == core);
+    }
+};
+
+
+void VCOWidget::appendContextMenu(Menu *menu) {
+    LRModuleWidget::appendContextMenu(menu);
+
+    auto *vco = dynamic_cast<VCO *>(module);
+    if (!vco) return;
+
+    menu->addChild(new MenuLabel());
+
+    const char *coreNames[] = {"Integrated BLIT (analogue)", "PolyBLEP (low CPU)"};
+
+    for (int i = 0; i < 2; i++) {
+        auto *item = createMenuItem<VCOCore>(coreNames[i]);
+        item->vco = vco;
+        item->core = (DSPBLOscillator::Core) i;
+        menu->addChild(item);
+    }
+}
+
+
 VCOWidget::VCOWidget(VCO *module) : LRModuleWidget(module) {
     panel->addSVGVariant(LRGestaltType::DARK, APP->window->loadSvg(asset::plugin(pluginInstance, "res/panels/VCO.svg")));
     panel->addSVGVariant(LRGestaltType::LIGHT, APP->window->loadSvg(asset::plugin(pluginInstance, "res/panels/Woldemar.svg")));
@@ -185,63 +257,45 @@ VCOWidget::VCOWidget(VCO *module) : LRModuleWidget(module) {
 
 
 void VCO::process(const ProcessArgs &args) {
+    int channels = std::max(1, inputs[VOCT1_INPUT].getChannels());
 
-    int size = inputs[VOCT1_INPUT].getChannels();
-
-    if (size == 0) size = 1;
-
-    for (int i = 0; i < size; i++) {
-        // if no oscillator for that channel found => create it
-        if (osc[i] == nullptr) {
-            DEBUG("osc created. channel: %d sum: %d", i, inputs[VOCT1_INPUT].getChannels());
-            osc[i] = new DSPBLOscillator(args.sampleRate);
-        }
-
-        float fm = clamp(inputs[FM_CV_INPUT].getVoltage(), -CV_BOUNDS, CV_BOUNDS) * 0.4f * dsp::quadraticBipolar(params[FM_CV_PARAM].getValue());
-        float tune = params[FREQUENCY_PARAM].getValue();
-        float pw;
+    for (int c = 0; c < channels; c++) {
+        cv[c] = inputs[VOCT1_INPUT].getVoltage(c) + inputs[VOCT2_INPUT].getPolyVoltage(c);
+        fm[c] = clamp(inputs[FM_CV_INPUT].getPolyVoltage(c), -CV_BOUNDS, CV_BOUNDS) * 0.4f * dsp::quadraticBipolar(params[FM_CV_PARAM].getValue());
 
         if (inputs[PW_CV_INPUT].isConnected()) {
-            pw = clamp(inputs[PW_CV_INPUT].getVoltage(), -CV_BOUNDS, CV_BOUNDS) * 0.6f *
-                 dsp::quadraticBipolar(params[PW_CV_PARAM].getValue() / 2.f) + 1;
-            pw = clamp(pw, 0.01, 1.99);
+            pw[c] = clamp(inputs[PW_CV_INPUT].getPolyVoltage(c), -CV_BOUNDS, CV_BOUNDS) * 0.6f *
+                    dsp::quadraticBipolar(params[PW_CV_PARAM].getValue() / 2.f) + 1;
+            pw[c] = clamp(pw[c], 0.01, 1.99);
         } else {
-            pw = params[PW_CV_PARAM].getValue() * 0.99f + 1;
+            pw[c] = params[PW_CV_PARAM].getValue() * 0.99f + 1;
         }
+    }
 
-        reflect->frqKnob->setIndicatorActive(inputs[FM_CV_INPUT].isConnected());
-        reflect->frqKnob->setIndicatorValue((params[FREQUENCY_PARAM].getValue() + 1) / 2 + (fm / 2));
-
-        osc[i]->setInputs(inputs[VOCT1_INPUT].getVoltage(i), inputs[VOCT2_INPUT].getVoltage(), fm, tune, lround(params[OCTAVE_PARAM].getValue()));
-        osc[i]->setPulseWidth(pw);
-
-        osc[i]->process();
-
-        outputs[SAW_OUTPUT].setVoltage(osc[i]->getSawWave(), i);
-        outputs[PULSE_OUTPUT].setVoltage(osc[i]->getPulseWave(), i);
-        outputs[SINE_OUTPUT].setVoltage(osc[i]->getSineWave(), i);
-        outputs[TRI_OUTPUT].setVoltage(osc[i]->getTriWave(), i);
-        outputs[NOISE_OUTPUT].setVoltage(osc[i]->getNoise(), i);
-
+    reflect->frqKnob->setIndicatorActive(inputs[FM_CV_INPUT].isConnected());
+    reflect->frqKnob->setIndicatorValue((params[FREQUENCY_PARAM].getValue() + 1) / 2 + (fm[0] / 2));
 
-        if (outputs[MIX_OUTPUT].isConnected()) {
-            float mix = 0.f;
+    bank->setChannels(channels);
+    bank->setCore(core);
+    bank->setInputs(cv, fm, pw, params[FREQUENCY_PARAM].getValue(), lround(params[OCTAVE_PARAM].getValue()));
 
-            mix += osc[i]->getSawWave() * params[SAW_PARAM].getValue();
-            mix += osc[i]->getPulseWave() * params[PULSE_PARAM].getValue();
-            mix += osc[i]->getSineWave() * params[SINE_PARAM].getValue();
-            mix += osc[i]->getTriWave() * params[TRI_PARAM].getValue();
+    bank->setMix(params[SAW_PARAM].getValue(), params[PULSE_PARAM].getValue(), params[SINE_PARAM].getValue(),
+                 params[TRI_PARAM].getValue());
+    bank->out[Bank::MIX] = outputs[MIX_OUTPUT].isConnected() ? outputs[MIX_OUTPUT].voltages : nullptr;
 
-            outputs[MIX_OUTPUT].setVoltage(mix, i);
-        }
+    for (int i = SAW_OUTPUT; i < NUM_OUTPUTS; i++) {
+        outputs[i].setChannels(channels);
     }
 
+    /* all voices are written straight into the output buffers */
+    bank->process();
+
     /* for LFO mode */
-    if (osc[0]->isLFO()) lights[LFO_LIGHT].setSmoothBrightness(osc[0]->getSineWave() / 10.f + 0.3f, args.sampleTime);
+    if (bank->isLFO()) lights[LFO_LIGHT].setSmoothBrightness(outputs[SINE_OUTPUT].getVoltage(0) / 10.f + 0.3f, args.sampleTime);
     else lights[LFO_LIGHT].value = 0.f;
 
-    reflect->lcd->active = osc[0]->isLFO();
-    reflect->lcd->value = osc[0]->getFrequency();
+    reflect->lcd->active = bank->isLFO();
+    reflect->lcd->value = bank->getFrequency(0);
 }
 
 
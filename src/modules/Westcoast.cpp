@@ -72,6 +72,49 @@ struct Westcoast : LRModule {
 
     WestcoastWidget *reflect;
 
+    /* adaptive oversampling, applied on the audio thread */
+    bool adaptive = false;
+    bool adaptiveApplied = false;
+    int activeFactor = 1;
+    double latency = 0.;
+
+
+    json_t *dataToJson() override {
+        json_t *rootJ = LRModule::dataToJson();
+        json_object_set_new(rootJ, "adaptive", json_boolean(adaptive));
+
+        return rootJ;
+    }
+
+
+    void dataFromJson(json_t *rootJ) override {
+        LRModule::dataFromJson(rootJ);
+
+        json_t *adaptiveJ = json_object_get(rootJ, "adaptive");
+
+        if (adaptiveJ)
+            adaptive = json_boolean_value(adaptiveJ);
+    }
+
+
+    void updateAdaptive() {
+        hs->setAdaptive(adaptive);
+        sg->setAdaptive(adaptive);
+        saturator->setAdaptive(adaptive);
+        hardclip->setAdaptive(adaptive);
+        reshaper->setAdaptive(adaptive);
+        overdrive->setAdaptive(adaptive);
+        fastTan->setAdaptive(adaptive);
+
+        adaptiveApplied = adaptive;
+    }
+
+
+    double getLatency() override {
+        return latency;
+    }
+
+
     void process(const ProcessArgs &args) override;
     void onSampleRateChange() override;
 };
@@ -92,9 +135,43 @@ struct WestcoastWidget : LRModuleWidget {
     LRMiddleKnob *biasBtn;
 
     WestcoastWidget(Westcoast *module);
+    void appendContextMenu(Menu *menu) override;
 };
 
 
+struct WestcoastAdaptive : MenuItem {
+    Westcoast *westcoast;
+
+
+    void onAction(const event::Action &e) override {
+        westcoast->adaptive ^= true;
+    }
+
+
+    void step() override {
+        rightText = CHECKMARK(westcoast->adaptive);
+    }
+};
+
+
+void WestcoastWidget::appendContextMenu(Menu *menu) {
+    LRModuleWidget::appendContextMenu(menu);
+
+    auto *westcoast = dynamic_cast<Westcoast *>(module);
+    if (!westcoast) return;
+
+    menu->addChild(new MenuLabel());
+
+    auto *adaptiveItem = createMenuItem<WestcoastAdaptive>("Adaptive oversampling");
+    adaptiveItem->westcoast = westcoast;
+    menu->addChild(adaptiveItem);
+
+    auto *factorLabel = new MenuLabel();
+    factorLabel->text = "Current oversampling: " + std::to_string(westcoast->activeFactor) + "x";
+    menu->addChild(factorLabel);
+}
+
+
 WestcoastWidget::WestcoastWidget(Westcoast *module) : LRModuleWidget(module) {
     panel->addSVGVariant(LRGestaltType::DARK, APP->window->loadSvg(asset::plugin(pluginInstance, "res/panels/Westcoast.svg")));
     panel->addSVGVariant(LRGestaltType::LIGHT, APP->window->loadSvg(asset::plugin(pluginInstance, "res/panels/WestcoastLight.svg")));
@@ -175,6 +252,8 @@ void Westcoast::process(const ProcessArgs &args) {
         reflect->biasBtn->setIndicatorValue((params[BIAS_PARAM].getValue() + (biascv + 6)) / 12);
     }
 
+    if (adaptive != adaptiveApplied) updateAdaptive();
+
     float out;
     float gain = params[GAIN_PARAM].getValue() + gaincv;
     float bias = params[BIAS_PARAM].getValue() + biascv;
@@ -187,6 +266,8 @@ void Westcoast::process(const ProcessArgs &args) {
 
             hs->process();
             out = (float) hs->getOut();
+            activeFactor = hs->getActiveFactor();
+            latency = hs->getLatency();
             break;
 
         case SERGE:     // Serge Model
@@ -196,6 +277,8 @@ void Westcoast::process(const ProcessArgs &args) {
 
             sg->process();
             out = (float) sg->getOut();
+            activeFactor = sg->getActiveFactor();
+            latency = sg->getLatency();
             break;
 
         case SATURATE: // Saturator
@@ -205,6 +288,8 @@ void Westcoast::process(const ProcessArgs &args) {
 
             saturator->process();
             out = (float) saturator->getOut();
+            activeFactor = saturator->getActiveFactor();
+            latency = saturator->getLatency();
             break;
 
         case HARDCLIP: // Hardclip
@@ -214,6 +299,8 @@ void Westcoast::process(const ProcessArgs &args) {
 
             hardclip->process();
             out = (float) hardclip->getOut();
+            activeFactor = hardclip->getActiveFactor();
+            latency = hardclip->getLatency();
             break;
 
         case RESHAPER: // ReShaper
@@ -223,6 +310,8 @@ void Westcoast::process(const ProcessArgs &args) {
 
             reshaper->process();
             out = (float) reshaper->getOut();
+            activeFactor = reshaper->getActiveFactor();
+            latency = reshaper->getLatency();
             break;
 
         case OVERDRIVE: // Overdrive
@@ -232,6 +321,8 @@ void Westcoast::process(const ProcessArgs &args) {
 
             overdrive->process();
             out = (float) overdrive->getOut();
+            activeFactor = overdrive->getActiveFactor();
+            latency = overdrive->getLatency();
             break;
 
         case VALERIE: // Overdrive
@@ -241,6 +332,8 @@ void Westcoast::process(const ProcessArgs &args) {
 
             fastTan->process();
             out = (float) fastTan->getOut();
+            activeFactor = fastTan->getActiveFactor();
+            latency = fastTan->getLatency();
             break;
 
         default: // invalid state, should not happen